@@ -7,6 +7,7 @@
 #include <cstddef>
 #include <memory>
 #include <ranges>
+#include <span>
 #include <utility>
 
 namespace xxx {
@@ -65,6 +66,11 @@ public:
     begin_ = buffer_.get();
   }
 
+  // unallocated space (valid until next allocation)
+  [[nodiscard]] auto free_space() const noexcept -> std::span<std::byte> {
+    return std::span(static_cast<std::byte*>(begin_), static_cast<std::byte*>(end_));
+  }
+
   template <typename T>
     requires std::is_trivially_destructible_v<T>
   [[nodiscard]] auto allocate(std::size_t count = 1) noexcept -> T* {
@@ -74,14 +80,24 @@ public:
   template <std::size_t Align>
     requires(std::popcount(Align) == 1)
   [[nodiscard]] auto allocate(std::size_t size) noexcept -> void* {
-    auto space = std::size_t(static_cast<std::byte*>(end_) - buffer_.get());
-    if (std::align(Align, size, begin_, space)) [[likely]] {
+    return this->allocate(size, Align);
+  }
+
+  [[nodiscard]] auto allocate(std::size_t size, std::size_t align) noexcept -> void* {
+    auto space = std::size_t(static_cast<std::byte*>(end_) - static_cast<std::byte*>(begin_));
+    if (std::align(align, size, begin_, space)) [[likely]] {
       auto const allocation_address = begin_;
       begin_ = static_cast<std::byte*>(begin_) + size;
       return allocation_address;
     }
     return nullptr;
   }
+
+  // check pointer belongs to allocator buffer
+  [[nodiscard]] auto owns(void const* p) const noexcept -> bool {
+    auto const address = static_cast<std::byte const*>(p);
+    return address >= buffer_.get() && address < static_cast<std::byte const*>(end_);
+  }
 };
 
 } // namespace xxx
@@ -3,9 +3,15 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <termbox2.h>
@@ -13,37 +19,75 @@
 #include "xxx.h"
 
 #include "im_allocator.h"
+#include "im_flex_layout.h"
 #include "im_hash_id.h"
+#include "im_hit_index.h"
 #include "im_input.h"
+#include "im_keymap.h"
 #include "im_layout.h"
+#include "im_memory_resource.h"
 #include "im_renderer.h"
+#include "im_spsc_queue.h"
 #include "im_stack.h"
+#include "im_text_buffer.h"
+#include "im_text_cache.h"
+#include "im_text_editor.h"
+#include "im_text_layout.h"
 #include "im_theme.h"
+#include "im_theme_file.h"
 
 namespace xxx {
 
 static_assert(std::is_same_v<uintattr_t, std::uint64_t>, "termbox2 invalid configuration");
 
-using im_clock = std::chrono::steady_clock;
-
 struct im_context {
+  // frame arena (reset on new frame)
   im_allocator allocator;
+  im_memory_resource frame_resource = im_memory_resource(allocator);
 
   im_input input;
+  im_keymap keymap;
   im_hash_id hash_id;
   im_theme theme;
+  im_theme_file theme_file;
+  im_text_cache text_cache;
+  im_text_layout_cache text_layout_cache;
+  im_flex_layout_cache flex_layout_cache;
   im_layout layout;
-  im_renderer renderer;
+  im_renderer renderer = im_renderer(&frame_resource);
 
   struct {
-    std::string current_title;
+    // formatted into frame arena
+    std::string_view current_title;
     im_id current_id = im_id();
     int current_flags = 0;
     im_id active_id = im_id();
     im_id force_next_id = im_id();
     bool active;
+    // view_begin(...) returned false, view_end() does nothing
+    bool skipped = false;
+    // first line of view
+    int top_y = 0;
+    // im_view_flag_scroll: content start line and visible height
+    int scroll_origin_y = 0;
+    int scroll_height = 0;
+    // viewport offset to restore on view_end()
+    im_vec2 prev_viewport_offset;
   } view;
 
+  // persistent views state
+  struct view_state {
+    // first visible content line (im_view_flag_scroll)
+    int scroll = 0;
+    // content height on previous frame
+    int content_height = 0;
+    // whole view height on previous frame
+    int height = 0;
+    // im_view_flag_collapsible
+    bool collapsed = false;
+  };
+  std::unordered_map<im_id, view_state> view_states;
+
   struct {
     im_id current_id = im_id();
     im_id active_id = im_id();
@@ -51,25 +95,104 @@ struct im_context {
     im_id next_id = im_id();
     bool active;
     bool pressed;
+    bool hovered;
+    bool clicked;
+    bool dragged;
   } widget;
 
+  // mouse interaction state (resolved against widgets of previous frame)
+  struct {
+    // widget under mouse cursor
+    im_id hot_id = im_id();
+    // widget left button pressed on (until released)
+    im_id captured_id = im_id();
+    // widget clicked during current frame
+    im_id clicked_id = im_id();
+    // mouse position on capture
+    im_vec2 drag_origin;
+  } mouse;
+
+  // visible focusable widgets of current frame
+  im_hit_index hit_index;
+
   struct {
     im_id active_id = im_id();
-    std::vector<std::uint32_t> text;
+    // edit state of active widget (std::string overload)
+    im_text_buffer buffer;
     int cursor_pos = 0;
     int scroll_offset = 0;
+    // buffer version copied to input string
+    std::uint64_t synced_version = 0;
+    // input string storage and size after last sync (detects changes outside of widget)
+    char const* synced_data = nullptr;
+    std::size_t synced_size = 0;
   } text_input;
 
+  // multi-line editors state
+  std::unordered_map<im_id, im_text_editor_state> text_editor;
+
+  // persistent grids state (keyed by grid order within view)
+  struct grid_state {
+    // rows heights measured on previous frame
+    std::vector<int> row_heights;
+  };
+  std::unordered_map<im_id, grid_state> grid_states;
+  // grids begun during current frame
+  int grid_count = 0;
+
+  // bracketed paste detection state
+  struct {
+    // paste in progress (begin marker received)
+    bool active = false;
+    // number of matched chars of begin (or end) marker
+    std::size_t marker_pos = 0;
+    // time of begin marker
+    im_clock::time_point time;
+    // text of paste in progress
+    std::vector<std::uint32_t> text;
+    // sanitized paste text not fitted into frame arena
+    std::vector<std::uint32_t> sanitized;
+  } paste;
+
+  // terminal replies to init queries
+  struct {
+    // keys typed while replies were awaited (passed to first frame input)
+    std::string input;
+    // replies didn't arrive in time, late ones are filtered from input until deadline
+    bool pending = false;
+    im_clock::time_point deadline;
+    // chars of reply matched so far
+    std::array<std::uint32_t, 32> matched;
+    std::size_t matched_size = 0;
+  } terminal_reply;
+
   struct {
     im_rect rect;
     im_vec2 size;
     std::span<im_cell> data;
   } canvas;
 
+  // statistics of last rendered frame
+  im_frame_stats frame_stats;
+
   // elapsed seconds since last new_frame(...)
 
   im_clock::time_point last_frame_time;
   float elapsed = 0.0;
+
+  // input thread state (see im_init_flag_input_thread)
+  // declared last to stop thread before the rest of context destroyed
+  struct input_thread_state {
+    static constexpr auto queue_capacity = std::size_t(4096);
+
+    // guards termbox2 calls shared with input thread (input read and output)
+    std::mutex terminal_mutex;
+    // decoded events waiting for process_input_events()
+    im_spsc_queue<im_input_event> queue{queue_capacity};
+    // termbox2 error input thread stopped with
+    std::atomic<int> error = TB_OK;
+    std::jthread thread;
+  } input_thread;
 };
 
 im_context* g_ctx = nullptr;
@@ -0,0 +1,117 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "im_flex_layout.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <ranges>
+
+#include "hash.h"
+
+namespace xxx {
+namespace {
+
+// share space between columns in proportion to weights, columns reached limit are frozen and their
+// rest is shared on next round (every round freezes at least one column or spends all space)
+template <typename Weight, typename Limit>
+void distribute(std::span<int> output, int space, Weight const& weight, Limit const& limit) noexcept {
+  auto const sign = space < 0 ? -1 : 1;
+  space = std::abs(space);
+
+  while (space > 0) {
+    auto total_weight = 0.0;
+    for (auto const i : std::views::iota(std::size_t(0), output.size())) {
+      total_weight += weight(i, output[i]);
+    }
+    if (total_weight <= 0.0) {
+      return;
+    }
+
+    // cumulative rounding keeps sum of shares equal to space
+    auto spent = 0;
+    auto frozen = false;
+    auto accumulated_weight = 0.0;
+    auto accumulated_share = 0;
+    for (auto const i : std::views::iota(std::size_t(0), output.size())) {
+      auto const w = weight(i, output[i]);
+      if (w <= 0.0) {
+        continue;
+      }
+      accumulated_weight += w;
+      auto const share = int(std::lround(space * accumulated_weight / total_weight)) - accumulated_share;
+      accumulated_share += share;
+
+      auto const room = limit(i, output[i]);
+      auto const value = std::min(share, room);
+      frozen |= (value == room);
+      output[i] += sign * value;
+      spent += value;
+    }
+
+    space -= spent;
+    if (!frozen) {
+      break;
+    }
+  }
+}
+
+} // namespace
+
+void solve_flex(std::span<im_flex const> columns, int width, std::span<int> output) noexcept {
+  assert(columns.size() == output.size());
+
+  auto total = 0;
+  for (auto const i : std::views::iota(std::size_t(0), columns.size())) {
+    auto const min = std::max(columns[i].min, 0);
+    output[i] = std::clamp(columns[i].basis, min, std::max(columns[i].max, min));
+    total += output[i];
+  }
+
+  if (total < width) {
+    distribute(
+        output, width - total,
+        [&](std::size_t i, int value) {
+          auto const max = std::max(columns[i].max, columns[i].min);
+          return value < max ? double(std::max(columns[i].grow, 0.0f)) : 0.0;
+        },
+        [&](std::size_t i, int value) { return std::max(columns[i].max, columns[i].min) - value; });
+  } else if (total > width) {
+    distribute(
+        output, width - total,
+        [&](std::size_t i, int value) { return double(value - std::max(columns[i].min, 0)); },
+        [&](std::size_t i, int value) { return value - std::max(columns[i].min, 0); });
+  }
+}
+
+auto im_flex_layout_cache::get(std::span<im_flex const> columns, int width) -> std::span<int const> {
+  auto const key = detail::mm3_32(columns.data(), columns.size_bytes(), hash(width, hash_seed));
+  if (auto const found = index_.find(key); found != index_.end()) [[likely]] {
+    auto const& [offset, count, entry_width] = found->second;
+    if (entry_width == width &&
+        std::ranges::equal(std::span(columns_).subspan(offset, count), columns, [](auto const& a, auto const& b) {
+          return a.basis == b.basis && a.min == b.min && a.max == b.max && a.grow == b.grow;
+        })) {
+      return std::span(widths_).subspan(offset, count);
+    }
+  }
+
+  if (widths_.size() + columns.size() > max_columns_) [[unlikely]] {
+    full_ = true;
+    scratch_.resize(columns.size());
+    solve_flex(columns, width, scratch_);
+    return scratch_;
+  }
+
+  auto const offset = std::uint32_t(widths_.size());
+  columns_.insert(columns_.end(), columns.begin(), columns.end());
+  widths_.resize(widths_.size() + columns.size());
+  auto const result = std::span(widths_).subspan(offset, columns.size());
+  solve_flex(columns, width, result);
+  // replaces entry on hash collision
+  index_.insert_or_assign(key, entry{.offset = offset, .count = std::uint32_t(columns.size()), .width = width});
+  return result;
+}
+
+} // namespace xxx
@@ -0,0 +1,70 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "xxx.h"
+
+namespace xxx {
+
+/// Solve flex row columns widths
+/// @param width is row width
+/// @param output is columns widths (same size as columns)
+void solve_flex(std::span<im_flex const> columns, int width, std::span<int> output) noexcept;
+
+/// Cache of flex rows solutions per constraints and row width
+///
+/// Rows repeated across frames are solved once, after that it's a single lookup per frame.
+/// Solutions are kept in single buffer, cache is dropped on next frame start when buffer is exhausted.
+class im_flex_layout_cache {
+private:
+  static constexpr auto hash_seed = std::uint32_t(0x5f1e8c21);
+
+  struct entry {
+    std::uint32_t offset;
+    std::uint32_t count;
+    int width;
+  };
+
+  std::size_t max_columns_;
+  // hash of constraints and width -> entry
+  std::unordered_map<std::uint32_t, entry> index_;
+  // constraints copy to resolve hash collision
+  std::vector<im_flex> columns_;
+  std::vector<int> widths_;
+  // solution of row not fitted into cache
+  std::vector<int> scratch_;
+  // buffer exhausted, drop cache on next frame
+  bool full_ = false;
+
+public:
+  im_flex_layout_cache(im_flex_layout_cache const&) = delete;
+  im_flex_layout_cache& operator=(im_flex_layout_cache const&) = delete;
+
+  /// @param max_columns is max number of cached columns
+  explicit im_flex_layout_cache(std::size_t max_columns = 4 * 1024) : max_columns_(max_columns) {
+    columns_.reserve(max_columns_);
+    widths_.reserve(max_columns_);
+  }
+
+  /// Start new frame
+  void new_frame() {
+    if (full_) [[unlikely]] {
+      index_.clear();
+      columns_.clear();
+      widths_.clear();
+      full_ = false;
+    }
+  }
+
+  /// Get columns widths
+  /// @return widths valid until next get(...) call
+  [[nodiscard]] auto get(std::span<im_flex const> columns, int width) -> std::span<int const>;
+};
+
+} // namespace xxx
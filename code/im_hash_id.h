@@ -17,7 +17,7 @@ enum class im_id : std::uint32_t {};
 
 class im_hash_id {
 private:
-  im_stack<im_id> hash_id_stack_ = im_stack<im_id>(32);
+  im_stack<im_id> hash_id_stack_;
 
 public:
   im_hash_id() = default;
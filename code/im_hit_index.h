@@ -0,0 +1,107 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "im_hash_id.h"
+#include "im_rect.h"
+#include "im_vec2.h"
+
+namespace xxx {
+
+/// Spatial index of widget rects (uniform grid over screen)
+///
+/// Each grid cell keeps a list of rects overlapping it, so point lookup touches only
+/// rects of one cell regardless of total widget count. Rebuilt every frame.
+class im_hit_index {
+public:
+  struct entry {
+    im_id id;
+    im_id view_id;
+    // visible part of widget in screen coordinates
+    im_rect rect;
+  };
+
+private:
+  static constexpr auto cell_size = im_vec2(16, 4);
+  static constexpr auto npos = std::numeric_limits<std::uint32_t>::max();
+
+  struct node {
+    std::uint32_t entry;
+    std::uint32_t next;
+  };
+
+  im_rect bounds_;
+  im_vec2 grid_size_ = im_vec2(0, 0);
+  // first node per grid cell
+  std::vector<std::uint32_t> cells_;
+  std::vector<node> nodes_;
+  std::vector<entry> entries_;
+
+public:
+  /// Remove all entries and resize grid to bounds
+  void reset(im_rect const& bounds) {
+    bounds_ = bounds;
+    grid_size_ = bounds.empty() ? im_vec2(0, 0)
+                                : im_vec2((bounds.width() + cell_size.x - 1) / cell_size.x,
+                                      (bounds.height() + cell_size.y - 1) / cell_size.y);
+    cells_.assign(grid_size_.x * grid_size_.y, npos);
+    nodes_.clear();
+    entries_.clear();
+  }
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return entries_.size();
+  }
+
+  /// Add widget rect (screen coordinates)
+  /// Later added entries are on top of earlier ones
+  void add(im_id id, im_id view_id, im_rect const& rect) {
+    auto const c_rect = bounds_.intersection(rect);
+    if (!c_rect) {
+      return;
+    }
+
+    auto const entry_index = static_cast<std::uint32_t>(entries_.size());
+    entries_.push_back(entry{.id = id, .view_id = view_id, .rect = c_rect});
+
+    auto const first = this->cell_of(c_rect.min);
+    auto const last = this->cell_of(c_rect.max);
+    for (int y = first.y; y <= last.y; ++y) {
+      for (int x = first.x; x <= last.x; ++x) {
+        auto& head = cells_[y * grid_size_.x + x];
+        nodes_.push_back(node{.entry = entry_index, .next = head});
+        head = static_cast<std::uint32_t>(nodes_.size() - 1);
+      }
+    }
+  }
+
+  /// Find top-most entry containing point
+  /// @return nullptr if nothing found
+  [[nodiscard]] auto find(im_vec2 const& pos) const noexcept -> entry const* {
+    if (!bounds_.contains(pos)) {
+      return nullptr;
+    }
+    auto const cell = this->cell_of(pos);
+    for (auto i = cells_[cell.y * grid_size_.x + cell.x]; i != npos; i = nodes_[i].next) {
+      auto const& result = entries_[nodes_[i].entry];
+      if (result.rect.contains(pos)) {
+        return &result;
+      }
+    }
+    return nullptr;
+  }
+
+private:
+  [[nodiscard]] auto cell_of(im_vec2 const& pos) const noexcept -> im_vec2 {
+    assert(bounds_.contains(pos));
+    return im_vec2((pos.x - bounds_.min.x) / cell_size.x, (pos.y - bounds_.min.y) / cell_size.y);
+  }
+};
+
+} // namespace xxx
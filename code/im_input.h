@@ -4,7 +4,10 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <cstdint>
+#include <span>
+#include <vector>
 
 #include "xxx.h"
 
@@ -12,25 +15,57 @@
 
 namespace xxx {
 
-// only key or ch
+using im_clock = std::chrono::steady_clock;
+
+enum class im_input_event_type {
+  none,
+  key,
+  character,
+  paste,
+  mouse_move,
+  mouse_button,
+  mouse_release,
+  mouse_wheel,
+  resize
+};
+
 struct im_input_event {
+  // im_input_event_type::none marks the end of a terminal read (no more input available),
+  // consumed events are marked none as well
+  im_input_event_type type = im_input_event_type::none;
+  // time event was decoded
+  im_clock::time_point time;
+  // im_input_event_type::key
   im_key_id key = im_key_id();
+  // im_input_event_type::character
   std::uint32_t ch = 0;
+  // im_input_event_type::mouse_*: mouse position
+  // im_input_event_type::resize: new screen size
+  im_vec2 pos = im_vec2(0, 0);
+  // im_input_event_type::mouse_button (terminal doesn't report which button released)
+  im_mouse_button_id button = im_mouse_button_id::last;
+  // im_input_event_type::mouse_wheel: scroll lines (negative is up)
+  int wheel = 0;
+  // im_input_event_type::paste: pasted text range (see im_input::get_paste_text(...))
+  std::uint32_t paste_offset = 0;
+  std::uint32_t paste_length = 0;
 };
 
 class im_input {
 private:
+  // initial events queue capacity (queue grows on demand)
+  static constexpr std::size_t events_initial_capacity = 256;
+
   struct keyboard_state {
     static constexpr std::size_t max_keys = static_cast<std::size_t>(im_key_id::last);
-    static constexpr std::size_t input_max_length = 16;
 
     struct key_state {
       std::size_t clicked = 0;
     };
 
     std::array<key_state, max_keys> keys;
-    std::array<im_input_event, input_max_length> input_events;
-    std::size_t input_events_length = 0;
+    // text of paste events
+    std::vector<std::uint32_t> paste_text;
   };
 
   struct mouse_state {
@@ -45,64 +80,138 @@ private:
     im_vec2 pos = im_vec2(-1, -1);
     im_vec2 prev = im_vec2(-1, -1);
     im_vec2 delta;
+    int wheel = 0;
   };
 
+  // ordered events since last reset
+  std::vector<im_input_event> events_;
   keyboard_state keyboard_;
   mouse_state mouse_;
 
 public:
-  im_input() = default;
+  im_input() {
+    events_.reserve(events_initial_capacity);
+  }
 
   [[nodiscard]] auto is_key_pressed(im_key_id id) const noexcept -> bool {
     assert(id < im_key_id::last);
     return keyboard_.keys[static_cast<std::size_t>(id)].clicked > 0;
   }
 
+  [[nodiscard]] auto mouse_pos() const noexcept -> im_vec2 const& {
+    return mouse_.pos;
+  }
+
+  [[nodiscard]] auto mouse_wheel() const noexcept -> int {
+    return mouse_.wheel;
+  }
+
+  /// Get all events since last reset in order of arrival
   [[nodiscard]] auto get_input_events() const noexcept -> std::span<im_input_event const> {
-    return std::span<im_input_event const>(keyboard_.input_events.data(), keyboard_.input_events_length);
+    return std::span<im_input_event const>(events_);
   }
 
-  void add_key_event(im_key_id id) noexcept {
-    assert(id < im_key_id::last);
-    keyboard_.keys[static_cast<std::size_t>(id)].clicked++;
-    if (keyboard_.input_events_length < keyboard_.input_events.size()) {
-      keyboard_.input_events[keyboard_.input_events_length++] = im_input_event{.key = id};
+  /// Remove event from input (matched by key bindings), event type is set to none
+  void consume_event(std::size_t index) noexcept {
+    assert(index < events_.size());
+    auto& event = events_[index];
+    if (event.type == im_input_event_type::key) {
+      auto& key = keyboard_.keys[static_cast<std::size_t>(event.key)];
+      key.clicked -= key.clicked > 0 ? 1 : 0;
     }
+    event.type = im_input_event_type::none;
   }
 
-  void add_mouse_pos_event(im_vec2 const& pos) noexcept {
-    mouse_.pos = pos;
-    mouse_.delta = mouse_.pos - mouse_.prev;
+  [[nodiscard]] auto get_paste_text(im_input_event const& event) const noexcept -> std::span<std::uint32_t const> {
+    assert(event.paste_offset + event.paste_length <= keyboard_.paste_text.size());
+    return std::span<std::uint32_t const>(keyboard_.paste_text.data() + event.paste_offset, event.paste_length);
   }
 
-  void add_mouse_button_event(im_mouse_button_id id, im_vec2 const& pos) noexcept {
-    assert(id < im_mouse_button_id::last);
+  /// Add event and update keyboard and mouse state
+  /// paste events expected to be added through im_input::add_paste(...)
+  void add_event(im_input_event const& event) {
+    switch (event.type) {
+    case im_input_event_type::key:
+      assert(event.key < im_key_id::last);
+      keyboard_.keys[static_cast<std::size_t>(event.key)].clicked++;
+      break;
+    case im_input_event_type::mouse_move:
+      if (event.pos == mouse_.pos) {
+        return;
+      }
+      mouse_.pos = event.pos;
+      mouse_.delta = mouse_.pos - mouse_.prev;
+      break;
+    case im_input_event_type::mouse_button: {
+      assert(event.button < im_mouse_button_id::last);
+      auto& button = mouse_.buttons[static_cast<std::size_t>(event.button)];
+      button.clicked++;
+      button.clicked_pos = event.pos;
+      mouse_.delta = im_vec2(0, 0);
+    } break;
+    case im_input_event_type::mouse_wheel:
+      mouse_.wheel += event.wheel;
+      break;
+    default:
+      break;
+    }
+    events_.push_back(event);
+  }
 
-    auto& button = mouse_.buttons[static_cast<std::size_t>(id)];
-    button.clicked++;
-    button.clicked_pos = pos;
-    mouse_.delta = im_vec2(0, 0);
+  void add_key_event(im_key_id id) {
+    this->add_event(im_input_event{.type = im_input_event_type::key, .time = im_clock::now(), .key = id});
   }
 
-  void add_character(std::uint32_t ch) noexcept {
-    if (keyboard_.input_events_length < keyboard_.input_events.size()) {
-      keyboard_.input_events[keyboard_.input_events_length++] = im_input_event{.ch = ch};
+  void add_mouse_pos_event(im_vec2 const& pos) {
+    this->add_event(im_input_event{.type = im_input_event_type::mouse_move, .time = im_clock::now(), .pos = pos});
+  }
+
+  void add_mouse_button_event(im_mouse_button_id id, im_vec2 const& pos) {
+    this->add_event(
+        im_input_event{.type = im_input_event_type::mouse_button, .time = im_clock::now(), .pos = pos, .button = id});
+  }
+
+  void add_mouse_wheel_event(int wheel, im_vec2 const& pos) {
+    this->add_event(
+        im_input_event{.type = im_input_event_type::mouse_wheel, .time = im_clock::now(), .pos = pos, .wheel = wheel});
+  }
+
+  void add_resize_event(im_vec2 const& size) {
+    this->add_event(im_input_event{.type = im_input_event_type::resize, .time = im_clock::now(), .pos = size});
+  }
+
+  void add_character(std::uint32_t ch) {
+    this->add_event(im_input_event{.type = im_input_event_type::character, .time = im_clock::now(), .ch = ch});
+  }
+
+  void add_paste(std::span<std::uint32_t const> text, im_clock::time_point time = im_clock::now()) {
+    if (text.empty()) {
+      return;
     }
+    auto const offset = keyboard_.paste_text.size();
+    keyboard_.paste_text.insert(keyboard_.paste_text.end(), text.begin(), text.end());
+    this->add_event(im_input_event{.type = im_input_event_type::paste,
+        .time = time,
+        .paste_offset = static_cast<std::uint32_t>(offset),
+        .paste_length = static_cast<std::uint32_t>(text.size())});
   }
 
-  void add_characters_utf8(char const* str) noexcept {
+  void add_characters_utf8(char const* str) {
     for (auto const ch : utf8_to_unicode(str)) {
       this->add_character(ch);
     }
   }
 
   void reset() noexcept {
+    events_.clear();
+
     keyboard_.keys.fill(keyboard_state::key_state{.clicked = 0});
-    keyboard_.input_events_length = 0;
+    keyboard_.paste_text.clear();
 
     mouse_.buttons.fill(mouse_state::button_state{.clicked = 0, .clicked_pos = im_vec2(0, 0)});
     mouse_.prev = mouse_.pos;
     mouse_.delta = im_vec2(0, 0);
+    mouse_.wheel = 0;
   }
 };
 
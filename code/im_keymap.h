@@ -0,0 +1,214 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <termbox2.h>
+
+#include "im_hash_id.h"
+#include "im_input.h"
+#include "im_keys.h"
+
+namespace xxx {
+
+/// Key bindings registry (trie of key sequences per scope)
+///
+/// Every input key advances pending trie node, so dispatch cost depends on number of keys
+/// pressed and not on number of bindings. While sequence is pending, keys are consumed by keymap
+/// (modal prefix), key not continuing the sequence cancels it. Scope is either a view id or im_id()
+/// for global bindings, bindings of active view take precedence.
+class im_keymap {
+public:
+  // sequence element: character code point or key id
+  using key_code = std::uint32_t;
+
+  static constexpr auto pending_timeout = std::chrono::milliseconds(1000);
+  // max keys in bound sequence
+  static constexpr std::size_t max_sequence_length = 8;
+
+private:
+  static constexpr auto key_flag = key_code(1) << 31;
+  static constexpr auto npos = std::numeric_limits<std::uint32_t>::max();
+
+  struct node {
+    im_id action = im_id();
+    bool has_action = false;
+    std::uint32_t children = 0;
+  };
+
+  std::vector<node> nodes_;
+  // (node << 32 | key) -> child node
+  std::unordered_map<std::uint64_t, std::uint32_t> edges_;
+  // scope -> root node
+  std::unordered_map<im_id, std::uint32_t> roots_;
+
+  // partially matched sequence
+  std::uint32_t pending_ = npos;
+  im_clock::time_point pending_time_;
+
+  // actions triggered during current frame
+  static constexpr std::size_t max_triggered = 16;
+  std::array<im_id, max_triggered> triggered_;
+  std::size_t triggered_count_ = 0;
+
+public:
+  [[nodiscard]] static constexpr auto make_key_code(im_key_id id) noexcept -> key_code {
+    return key_flag | static_cast<key_code>(id);
+  }
+
+  /// Parse key sequence element: key label (see get_key_label(...)) or single utf8 character
+  [[nodiscard]] static auto parse_key_code(std::string_view token) noexcept -> std::optional<key_code> {
+    if (token.empty()) {
+      return std::nullopt;
+    }
+    for (auto const& desc : im_key_descs) {
+      if (desc.label == token) {
+        return make_key_code(desc.id);
+      }
+    }
+    if (auto const length = ::tb_utf8_char_length(token[0]); std::size_t(length) == token.size()) {
+      std::uint32_t ch;
+      ::tb_utf8_char_to_unicode(&ch, token.data());
+      // space is delivered as key
+      return ch == ' ' ? make_key_code(im_key_id::space) : key_code(ch);
+    }
+    return std::nullopt;
+  }
+
+  /// Bind key sequence to action in scope
+  /// Rebinding the same sequence replaces action
+  void bind(im_id scope, std::span<key_code const> keys, im_id action) {
+    if (keys.empty()) [[unlikely]] {
+      return;
+    }
+    auto current = this->root(scope);
+    for (auto const key : keys) {
+      auto [it, inserted] = edges_.try_emplace(edge(current, key), std::uint32_t(nodes_.size()));
+      if (inserted) {
+        nodes_[current].children++;
+        nodes_.emplace_back();
+      }
+      current = it->second;
+    }
+    nodes_[current].action = action;
+    nodes_[current].has_action = true;
+    // bindings changed, drop partial match
+    pending_ = npos;
+  }
+
+  /// Match input events of current frame
+  /// Keys matched by bindings (and keys breaking pending sequence) are consumed, so widgets don't see them
+  /// @param view_id is active view
+  void process(im_input& input, im_id view_id, im_clock::time_point now) {
+    triggered_count_ = 0;
+
+    // pending sequence which is a complete binding itself fires on timeout
+    if (pending_ != npos && now - pending_time_ > pending_timeout) {
+      this->trigger(std::exchange(pending_, npos));
+    }
+
+    auto const events = input.get_input_events();
+    for (std::size_t i = 0; i < events.size(); ++i) {
+      auto const& event = events[i];
+      auto consumed = false;
+      if (event.type == im_input_event_type::key) {
+        consumed = this->feed(make_key_code(event.key), view_id, event.time);
+      } else if (event.type == im_input_event_type::character && event.ch != ' ') {
+        consumed = this->feed(key_code(event.ch), view_id, event.time);
+      }
+      if (consumed) {
+        input.consume_event(i);
+      }
+    }
+  }
+
+  [[nodiscard]] auto is_triggered(im_id action) const noexcept -> bool {
+    auto const triggered = std::span(triggered_).first(triggered_count_);
+    return std::ranges::find(triggered, action) != triggered.end();
+  }
+
+  /// Check partially matched sequence exists
+  [[nodiscard]] auto is_pending() const noexcept -> bool {
+    return pending_ != npos;
+  }
+
+private:
+  [[nodiscard]] static constexpr auto edge(std::uint32_t node, key_code key) noexcept -> std::uint64_t {
+    return (std::uint64_t(node) << 32) | key;
+  }
+
+  auto root(im_id scope) -> std::uint32_t {
+    auto [it, inserted] = roots_.try_emplace(scope, std::uint32_t(nodes_.size()));
+    if (inserted) {
+      nodes_.emplace_back();
+    }
+    return it->second;
+  }
+
+  [[nodiscard]] auto child(std::uint32_t node, key_code key) const noexcept -> std::uint32_t {
+    auto const found = edges_.find(edge(node, key));
+    return found != edges_.end() ? found->second : npos;
+  }
+
+  // @return true on key consumed
+  auto feed(key_code key, im_id view_id, im_clock::time_point time) -> bool {
+    auto next = npos;
+    if (pending_ != npos) {
+      next = this->child(pending_, key);
+      if (next == npos) {
+        auto const pending = std::exchange(pending_, npos);
+        if (!nodes_[pending].has_action) {
+          // sequence broken, pending prefix swallows key
+          return true;
+        }
+        // complete binding fires, key starts new sequence
+        this->trigger(pending);
+      }
+    }
+    if (next == npos) {
+      for (auto const scope : {view_id, im_id()}) {
+        if (auto const found = roots_.find(scope); found != roots_.end()) {
+          if (next = this->child(found->second, key); next != npos) {
+            break;
+          }
+        }
+      }
+    }
+    if (next == npos) {
+      return false;
+    }
+
+    if (nodes_[next].children == 0) {
+      this->trigger(next);
+    } else {
+      pending_ = next;
+      pending_time_ = time;
+    }
+    return true;
+  }
+
+  void trigger(std::uint32_t node) {
+    if (!nodes_[node].has_action) {
+      return;
+    }
+    if (triggered_count_ == max_triggered) [[unlikely]] {
+      assert(false && "im_keymap::trigger(...) too many actions triggered during frame");
+      return;
+    }
+    triggered_[triggered_count_++] = nodes_[node].action;
+  }
+};
+
+} // namespace xxx
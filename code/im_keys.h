@@ -0,0 +1,168 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include <termbox2.h>
+
+#include "xxx.h"
+
+namespace xxx {
+
+/// Keyboard key descriptor: termbox2 key code and modifiers mapped to key id
+struct im_key_desc {
+  std::uint16_t tb_key;
+  std::uint8_t tb_mod;
+  im_key_id id;
+  std::string_view label;
+};
+
+/// All recognized keys
+/// Modifiers of ascii control keys are implied by key code (ctrl_*) and ignored
+inline constexpr auto im_key_descs = std::to_array<im_key_desc>({
+    {TB_KEY_BACKSPACE, 0, im_key_id::backspace, "bs"},
+    {TB_KEY_BACKSPACE2, 0, im_key_id::backspace2, "bs"},
+    {TB_KEY_DELETE, 0, im_key_id::del, "del"},
+    {TB_KEY_TAB, 0, im_key_id::tab, "tab"},
+    {TB_KEY_ENTER, 0, im_key_id::enter, "enter"},
+    {TB_KEY_SPACE, 0, im_key_id::space, "space"},
+    {TB_KEY_ESC, 0, im_key_id::esc, "esc"},
+    {TB_KEY_HOME, 0, im_key_id::home, "home"},
+    {TB_KEY_END, 0, im_key_id::end, "end"},
+    {TB_KEY_ARROW_UP, 0, im_key_id::arrow_up, "up"},
+    {TB_KEY_ARROW_DOWN, 0, im_key_id::arrow_down, "down"},
+    {TB_KEY_ARROW_LEFT, 0, im_key_id::arrow_left, "left"},
+    {TB_KEY_ARROW_RIGHT, 0, im_key_id::arrow_right, "right"},
+    {TB_KEY_CTRL_A, 0, im_key_id::ctrl_a, "c-a"},
+    {TB_KEY_CTRL_B, 0, im_key_id::ctrl_b, "c-b"},
+    {TB_KEY_CTRL_C, 0, im_key_id::ctrl_c, "c-c"},
+    {TB_KEY_CTRL_D, 0, im_key_id::ctrl_d, "c-d"},
+    {TB_KEY_CTRL_E, 0, im_key_id::ctrl_e, "c-e"},
+    {TB_KEY_CTRL_F, 0, im_key_id::ctrl_f, "c-f"},
+    {TB_KEY_CTRL_G, 0, im_key_id::ctrl_g, "c-g"},
+    {TB_KEY_CTRL_J, 0, im_key_id::ctrl_j, "c-j"},
+    {TB_KEY_CTRL_K, 0, im_key_id::ctrl_k, "c-k"},
+    {TB_KEY_CTRL_N, 0, im_key_id::ctrl_n, "c-n"},
+    {TB_KEY_CTRL_O, 0, im_key_id::ctrl_o, "c-o"},
+    {TB_KEY_CTRL_P, 0, im_key_id::ctrl_p, "c-p"},
+    {TB_KEY_CTRL_Q, 0, im_key_id::ctrl_q, "c-q"},
+    {TB_KEY_CTRL_R, 0, im_key_id::ctrl_r, "c-r"},
+    {TB_KEY_CTRL_S, 0, im_key_id::ctrl_s, "c-s"},
+    {TB_KEY_CTRL_T, 0, im_key_id::ctrl_t, "c-t"},
+    {TB_KEY_CTRL_U, 0, im_key_id::ctrl_u, "c-u"},
+    {TB_KEY_CTRL_V, 0, im_key_id::ctrl_v, "c-v"},
+    {TB_KEY_CTRL_W, 0, im_key_id::ctrl_w, "c-w"},
+    {TB_KEY_CTRL_X, 0, im_key_id::ctrl_x, "c-x"},
+    {TB_KEY_CTRL_Y, 0, im_key_id::ctrl_y, "c-y"},
+    {TB_KEY_CTRL_Z, 0, im_key_id::ctrl_z, "c-z"},
+    {TB_KEY_INSERT, 0, im_key_id::insert, "ins"},
+    {TB_KEY_PGUP, 0, im_key_id::pgup, "pgup"},
+    {TB_KEY_PGDN, 0, im_key_id::pgdn, "pgdn"},
+    {TB_KEY_BACK_TAB, 0, im_key_id::back_tab, "s-tab"},
+    {TB_KEY_F1, 0, im_key_id::f1, "f1"},
+    {TB_KEY_F2, 0, im_key_id::f2, "f2"},
+    {TB_KEY_F3, 0, im_key_id::f3, "f3"},
+    {TB_KEY_F4, 0, im_key_id::f4, "f4"},
+    {TB_KEY_F5, 0, im_key_id::f5, "f5"},
+    {TB_KEY_F6, 0, im_key_id::f6, "f6"},
+    {TB_KEY_F7, 0, im_key_id::f7, "f7"},
+    {TB_KEY_F8, 0, im_key_id::f8, "f8"},
+    {TB_KEY_F9, 0, im_key_id::f9, "f9"},
+    {TB_KEY_F10, 0, im_key_id::f10, "f10"},
+    {TB_KEY_F11, 0, im_key_id::f11, "f11"},
+    {TB_KEY_F12, 0, im_key_id::f12, "f12"},
+    {TB_KEY_ARROW_UP, TB_MOD_SHIFT, im_key_id::shift_arrow_up, "s-up"},
+    {TB_KEY_ARROW_DOWN, TB_MOD_SHIFT, im_key_id::shift_arrow_down, "s-down"},
+    {TB_KEY_ARROW_LEFT, TB_MOD_SHIFT, im_key_id::shift_arrow_left, "s-left"},
+    {TB_KEY_ARROW_RIGHT, TB_MOD_SHIFT, im_key_id::shift_arrow_right, "s-right"},
+    {TB_KEY_ARROW_UP, TB_MOD_ALT, im_key_id::alt_arrow_up, "a-up"},
+    {TB_KEY_ARROW_DOWN, TB_MOD_ALT, im_key_id::alt_arrow_down, "a-down"},
+    {TB_KEY_ARROW_LEFT, TB_MOD_ALT, im_key_id::alt_arrow_left, "a-left"},
+    {TB_KEY_ARROW_RIGHT, TB_MOD_ALT, im_key_id::alt_arrow_right, "a-right"},
+    {TB_KEY_ARROW_UP, TB_MOD_CTRL, im_key_id::ctrl_arrow_up, "c-up"},
+    {TB_KEY_ARROW_DOWN, TB_MOD_CTRL, im_key_id::ctrl_arrow_down, "c-down"},
+    {TB_KEY_ARROW_LEFT, TB_MOD_CTRL, im_key_id::ctrl_arrow_left, "c-left"},
+    {TB_KEY_ARROW_RIGHT, TB_MOD_CTRL, im_key_id::ctrl_arrow_right, "c-right"},
+});
+
+namespace detail {
+
+// dense lookup table layout:
+//   [0, 0x80) - ascii control keys
+//   [0x80, ...) - special keys (0xffff - n) for each modifiers combination
+inline constexpr auto key_ascii_count = std::size_t(0x80);
+inline constexpr auto key_special_count = std::size_t(64);
+inline constexpr auto key_mod_mask = std::uint8_t(TB_MOD_ALT | TB_MOD_CTRL | TB_MOD_SHIFT);
+inline constexpr auto key_slot_count = key_ascii_count + key_special_count * (key_mod_mask + 1);
+inline constexpr auto key_slot_none = key_slot_count;
+
+[[nodiscard]] constexpr auto key_slot(std::uint16_t key, std::uint8_t mod) noexcept -> std::size_t {
+  if (key < key_ascii_count) {
+    return key;
+  }
+  auto const special = std::size_t(0xffff - key);
+  if (special >= key_special_count) {
+    return key_slot_none;
+  }
+  return key_ascii_count + special * (key_mod_mask + 1) + (mod & key_mod_mask);
+}
+
+inline constexpr auto key_id_table = [] {
+  auto result = std::array<im_key_id, key_slot_count>();
+  for (auto const& desc : im_key_descs) {
+    result[key_slot(desc.tb_key, desc.tb_mod)] = desc.id;
+  }
+  return result;
+}();
+
+inline constexpr auto key_label_table = [] {
+  auto result = std::array<std::string_view, static_cast<std::size_t>(im_key_id::last)>();
+  for (auto const& desc : im_key_descs) {
+    result[static_cast<std::size_t>(desc.id)] = desc.label;
+  }
+  return result;
+}();
+
+// every descriptor has own slot
+static_assert([] {
+  auto used = std::array<bool, key_slot_count>();
+  for (auto const& desc : im_key_descs) {
+    auto const slot = key_slot(desc.tb_key, desc.tb_mod);
+    if (slot == key_slot_none || used[slot]) {
+      return false;
+    }
+    used[slot] = true;
+  }
+  return true;
+}());
+
+} // namespace detail
+
+/// Translate termbox2 key code and modifiers into key id
+/// Unknown modifiers combination of known key is translated as key without modifiers
+/// @return im_key_id() on unknown key
+[[nodiscard]] constexpr auto translate_key(std::uint16_t tb_key, std::uint8_t tb_mod) noexcept -> im_key_id {
+  auto const slot = detail::key_slot(tb_key, tb_mod);
+  if (slot == detail::key_slot_none) {
+    return im_key_id();
+  }
+  if (auto const id = detail::key_id_table[slot]; id != im_key_id()) {
+    return id;
+  }
+  return detail::key_id_table[detail::key_slot(tb_key, 0)];
+}
+
+static_assert(translate_key(TB_KEY_HOME, TB_MOD_SHIFT) == im_key_id::home);
+static_assert(translate_key(TB_KEY_ARROW_UP, TB_MOD_CTRL | TB_MOD_SHIFT) == im_key_id::arrow_up);
+static_assert(translate_key(TB_KEY_ARROW_UP, TB_MOD_CTRL) == im_key_id::ctrl_arrow_up);
+
+/// Get short key label (i.e. "c-x")
+[[nodiscard]] constexpr auto get_key_label(im_key_id id) noexcept -> std::string_view {
+  return id < im_key_id::last ? detail::key_label_table[static_cast<std::size_t>(id)] : std::string_view();
+}
+
+} // namespace xxx
@@ -32,8 +32,9 @@ namespace xxx {
 
 enum class im_layout_type {
   container, // layout is fixed size and fixed pos
-  column,    // layout is column of a row
-  row        // layout is row
+  column,    // layout is column of a row or cell of a grid
+  row,       // layout is row
+  grid       // layout is grid
 };
 
 struct im_layout_data_none {};
@@ -43,9 +44,21 @@ struct im_layout_data_container {
 };
 
 struct im_layout_data_row {
-  int columns;      // columns count inside row
-  int index;        // current column index
-  int cursor_max_y; // track max y over all columns on row
+  int columns;       // columns count inside row
+  int index;         // current column index
+  int cursor_max_y;  // track max y over all columns on row
+  int const* widths; // columns widths of flex row (nullptr - widths are set by push)
+};
+
+struct im_layout_data_grid {
+  int columns;        // columns count
+  int rows;           // rows count
+  int const* offsets; // columns start x (columns + 1 values, last one is end of grid)
+  int row;            // current row index
+  int row_y;          // current row start y
+  int row_height;     // fixed row height (0 - row fits tallest cell)
+  int cursor_max_y;   // track max y over all cells on current row
+  int* row_heights;   // rows heights of previous frame, updated as rows end (rows values)
 };
 
 struct im_layout_state {
@@ -60,13 +73,14 @@ struct im_layout_state {
     im_layout_data_none none = {};
     im_layout_data_container container;
     im_layout_data_row row;
+    im_layout_data_grid grid;
   };
 };
 
 struct im_layout {
   static constexpr auto spacing = im_vec2(1, 0);
 
-  im_stack<im_layout_state> layout_state_stack = im_stack<im_layout_state>(32);
+  im_stack<im_layout_state> layout_state_stack;
   im_vec2 cursor = im_vec2(0, 0);
   int last_cursor_y = 0;
   bool same_line = false;
@@ -78,6 +92,12 @@ struct im_layout {
     bool same_line = false;
   } widget_item;
 
+  /// Width available for next widget item (rest of line if it's placed on the same line)
+  [[nodiscard]] auto available_width() const noexcept -> int {
+    auto const& layout = layout_state_stack.back();
+    return layout.rect.max.x - (same_line ? cursor.x : layout.rect.min.x) + 1;
+  }
+
   /// Reserve layout space (number of top lines)
   auto reserve_layout_lines(int height) noexcept -> im_rect {
     if (height <= 0) [[unlikely]] {
@@ -0,0 +1,66 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "im_allocator.h"
+
+namespace xxx {
+
+/// Memory resource over linear allocator (frame arena)
+///
+/// Deallocation is no-op, memory is released by im_allocator::reset(). Containers using resource must be
+/// recreated after reset. Allocations not fitted into arena are served by upstream resource and counted.
+class im_memory_resource final : public std::pmr::memory_resource {
+private:
+  im_allocator* allocator_;
+  std::pmr::memory_resource* upstream_;
+  std::size_t upstream_allocations_ = 0;
+
+public:
+  explicit im_memory_resource(
+      im_allocator& allocator, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) noexcept
+      : allocator_(&allocator), upstream_(upstream) {}
+
+  /// Number of allocations served by upstream since last reset_stats()
+  [[nodiscard]] auto upstream_allocations() const noexcept -> std::size_t {
+    return upstream_allocations_;
+  }
+
+  void reset_stats() noexcept {
+    upstream_allocations_ = 0;
+  }
+
+private:
+  auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override {
+    if (auto const result = allocator_->allocate(bytes, alignment); result) [[likely]] {
+      return result;
+    }
+    upstream_allocations_++;
+    return upstream_->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+    if (!allocator_->owns(p)) [[unlikely]] {
+      upstream_->deallocate(p, bytes, alignment);
+    }
+  }
+
+  auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override {
+    return this == &other;
+  }
+};
+
+/// Vector allocated from memory resource (i.e. frame arena)
+template <typename T>
+using im_vector = std::pmr::vector<T>;
+
+/// String allocated from memory resource (i.e. frame arena)
+using im_string = std::pmr::string;
+
+} // namespace xxx
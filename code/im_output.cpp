@@ -0,0 +1,442 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "im_output.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "unicode.h"
+
+namespace xxx {
+namespace {
+
+struct sgr_attr_desc {
+  std::uint64_t attr;
+  unsigned code;
+};
+
+// termbox2 attribute flags to SGR codes
+constexpr auto sgr_attr_descs = std::to_array<sgr_attr_desc>({
+    {TB_BOLD, 1},
+    {TB_DIM, 2},
+    {TB_ITALIC, 3},
+    {TB_UNDERLINE, 4},
+    {TB_BLINK, 5},
+    {TB_REVERSE, 7},
+    {TB_INVISIBLE, 8},
+    {TB_STRIKEOUT, 9},
+    {TB_UNDERLINE_2, 21},
+    {TB_OVERLINE, 53},
+});
+
+constexpr auto sync_begin = std::string_view("\x1b[?2026h");
+constexpr auto sync_end = std::string_view("\x1b[?2026l");
+
+constexpr auto rgb_mask = std::uint64_t(0xffffff);
+// attribute bits which are part of color
+constexpr auto color_mask = rgb_mask | TB_HI_BLACK | TB_BRIGHT;
+
+struct reply {
+  // position and size of whole reply
+  std::size_t pos;
+  std::size_t size;
+  std::string_view params;
+};
+
+// find reply "CSI ? <params> <final>" (params are digits and ';')
+// @return reply or nullopt if there is no complete reply
+[[nodiscard]] auto find_reply(std::string_view data, std::string_view final) noexcept -> std::optional<reply> {
+  for (auto pos = data.find("\x1b[?"); pos != std::string_view::npos; pos = data.find("\x1b[?", pos + 1)) {
+    auto const params_begin = pos + 3;
+    auto const params_end = data.find_first_not_of("0123456789;", params_begin);
+    if (params_end != std::string_view::npos && data.substr(params_end).starts_with(final)) {
+      return reply{.pos = pos,
+          .size = params_end + final.size() - pos,
+          .params = data.substr(params_begin, params_end - params_begin)};
+    }
+  }
+  return std::nullopt;
+}
+
+[[nodiscard]] auto write_all(int fd, std::string_view data) noexcept -> bool {
+  while (!data.empty()) {
+    auto const rc = ::write(fd, data.data(), data.size());
+    if (rc < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      return false;
+    }
+    data.remove_prefix(std::size_t(rc));
+  }
+  return true;
+}
+
+} // namespace
+
+auto query_synchronized_output(int fd, std::chrono::milliseconds timeout, std::string& input)
+    -> std::optional<bool> {
+  // DECRQM mode 2026, DA1
+  if (!write_all(fd, "\x1b[?2026$p\x1b[c")) {
+    return false;
+  }
+
+  auto const deadline = std::chrono::steady_clock::now() + timeout;
+  input.clear();
+  while (!find_reply(input, "c")) {
+    auto const left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    if (left.count() <= 0) {
+      // no reply in time, it may still arrive late
+      return std::nullopt;
+    }
+    auto pfd = ::pollfd{.fd = fd, .events = POLLIN, .revents = 0};
+    if (auto const rc = ::poll(&pfd, 1, int(left.count())); rc <= 0) {
+      if (rc < 0 && errno == EINTR) {
+        continue;
+      }
+      return rc == 0 ? std::nullopt : std::optional<bool>(false);
+    }
+    char buffer[256];
+    auto const rc = ::read(fd, buffer, sizeof(buffer));
+    if (rc < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      return false;
+    }
+    if (rc == 0) {
+      return false;
+    }
+    input.append(buffer, std::size_t(rc));
+  }
+
+  // replies are cut out, the rest is user input
+  auto const da1 = *find_reply(input, "c");
+  input.erase(da1.pos, da1.size);
+
+  // "CSI ? 2026 ; Ps $ y": 1 - set, 2 - reset, 3 - permanently set, 0 or 4 - not supported
+  auto const mode = find_reply(input, "$y");
+  if (!mode) {
+    return false;
+  }
+  auto const params = mode->params;
+  auto const result = params.starts_with("2026;") && params.size() == 6 && params[5] >= '1' && params[5] <= '3';
+  input.erase(mode->pos, mode->size);
+  return result;
+}
+
+void im_output::resize(im_vec2 const& size) {
+  if (size == size_) [[likely]] {
+    return;
+  }
+  size_ = size;
+  auto const count = std::size_t(std::max(size.x, 0)) * std::size_t(std::max(size.y, 0));
+  front_.assign(count, im_cell());
+  back_.assign(count, im_cell());
+  front_hashes_.assign(std::size_t(std::max(size.y, 0)), 0);
+  back_hashes_.assign(std::size_t(std::max(size.y, 0)), 0);
+  invalid_ = true;
+}
+
+void im_output::clear(im_style const& style) {
+  auto const blank = im_cell{.ch = ' ', .style = style};
+  std::ranges::fill(back_, blank);
+  std::ranges::fill(back_hashes_, this->row_hash(blank));
+}
+
+void im_output::present(im_frame_stats& stats) {
+  buffer_.clear();
+  if (synchronized_) {
+    buffer_ += sync_begin;
+  }
+  auto const header_size = buffer_.size();
+  auto cells = std::size_t(0);
+
+  if (invalid_) {
+    // front buffer matches cleared screen
+    buffer_ += "\x1b[0m\x1b[2J";
+    auto const blank = im_cell{.ch = ' ', .style = im_style()};
+    std::ranges::fill(front_, blank);
+    std::ranges::fill(front_hashes_, this->row_hash(blank));
+    sgr_ = im_style();
+    cursor_ = im_vec2(-1, -1);
+    invalid_ = false;
+  } else {
+    this->scroll_rows();
+  }
+
+  auto skipped_rows = std::size_t(0);
+  for (int y = 0; y < size_.y; ++y) {
+    if (back_hashes_[y] == front_hashes_[y]) {
+      skipped_rows++;
+      continue;
+    }
+    auto const row = std::size_t(y) * size_.x;
+    for (int x = 0; x < size_.x;) {
+      auto const& cell = back_[row + x];
+      auto& front = front_[row + x];
+      auto ch = cell.ch < 0x20 || cell.ch == 0x7f ? std::uint32_t(' ') : cell.ch;
+      auto width = std::max(char_width(ch), 1);
+      if (x + width > size_.x) {
+        // no room for wide character
+        ch = ' ';
+        width = 1;
+      }
+
+      if (cell != front) {
+        this->append_cursor_move(x, y);
+        this->append_sgr(cell.style);
+        this->append_char(ch);
+        front = cell;
+        // cells covered by wide character are redrawn when it's gone
+        for (int i = 1; i < width; ++i) {
+          front_[row + x + i].ch = invalid_ch;
+        }
+        // cursor position after write into last column is terminal specific
+        cursor_ = x + width < size_.x ? im_vec2(x + width, y) : im_vec2(-1, -1);
+        cells++;
+      }
+
+      x += width;
+    }
+  }
+
+  front_hashes_ = back_hashes_;
+
+  if (buffer_.size() == header_size) {
+    // nothing changed
+    buffer_.clear();
+  } else if (synchronized_) {
+    buffer_ += sync_end;
+  }
+  this->flush();
+
+  stats.output_bytes = buffer_.size();
+  stats.output_cells = cells;
+  stats.skipped_rows = skipped_rows;
+  stats.changed_rows = std::size_t(size_.y) - skipped_rows;
+}
+
+auto im_output::row_hash(im_cell const& cell) const noexcept -> std::uint64_t {
+  auto result = std::uint64_t(0);
+  for (int x = 0; x < size_.x; ++x) {
+    result ^= cell_hash(x, cell);
+  }
+  return result;
+}
+
+void im_output::scroll_rows() {
+  auto const height = size_.y;
+  if (std::ranges::equal(front_hashes_, back_hashes_)) [[likely]] {
+    return;
+  }
+
+  // back row y shows front row (y + shift), look for longest run of such rows weighted by rows which
+  // differ without shift, minus rows scrolled in (terminal blanks them, they are repainted)
+  struct {
+    int shift = 0;
+    int top = 0;
+    int bottom = 0;
+    int gain = 0;
+  } best;
+
+  // shifts are checked by growing distance, net gain of distance is at most (height - 2 * distance),
+  // so search stops once it can't beat the best one (small scrolls are found in few passes)
+  for (int distance = 1; height - 2 * distance > best.gain; ++distance) {
+    for (auto const shift : {distance, -distance}) {
+      auto top = -1;
+      auto gain = 0;
+      for (int y = std::max(0, -shift); y < std::min(height, height - shift); ++y) {
+        if (back_hashes_[y] != front_hashes_[y + shift]) {
+          top = -1;
+          continue;
+        }
+        if (top < 0) {
+          top = y;
+          gain = -distance;
+        }
+        if (back_hashes_[y] != front_hashes_[y]) {
+          gain++;
+        }
+        if (gain > best.gain) {
+          best = {.shift = shift, .top = top, .bottom = y, .gain = gain};
+        }
+      }
+    }
+  }
+
+  if (best.gain < scroll_min_rows) {
+    return;
+  }
+
+  // region contains source and destination rows
+  auto const lines = std::abs(best.shift);
+  auto const region_top = best.shift > 0 ? best.top : best.top - lines;
+  auto const region_bottom = best.shift > 0 ? best.bottom + lines : best.bottom;
+
+  // DECSTBM, SU or SD, reset scroll region (cursor is moved to home position)
+  buffer_ += "\x1b[";
+  this->append_number(unsigned(region_top + 1));
+  buffer_ += ';';
+  this->append_number(unsigned(region_bottom + 1));
+  buffer_ += "r\x1b[";
+  if (lines > 1) {
+    this->append_number(unsigned(lines));
+  }
+  buffer_ += best.shift > 0 ? "S\x1b[r" : "T\x1b[r";
+  cursor_ = im_vec2(-1, -1);
+
+  // shift front buffer rows, rows scrolled in are filled by terminal with its blank cells, repaint them
+  auto const width = std::size_t(size_.x);
+  auto const move_row = [&](int to, int from) {
+    std::ranges::copy_n(front_.begin() + from * width, width, front_.begin() + to * width);
+    front_hashes_[to] = front_hashes_[from];
+  };
+  auto const invalidate_row = [&](int y) {
+    std::ranges::fill_n(front_.begin() + y * width, width, im_cell{.ch = invalid_ch, .style = im_style()});
+    front_hashes_[y] = 0;
+  };
+  if (best.shift > 0) {
+    for (int y = region_top; y <= region_bottom - lines; ++y) {
+      move_row(y, y + lines);
+    }
+    for (int y = region_bottom - lines + 1; y <= region_bottom; ++y) {
+      invalidate_row(y);
+    }
+  } else {
+    for (int y = region_bottom; y >= region_top + lines; --y) {
+      move_row(y, y - lines);
+    }
+    for (int y = region_top; y < region_top + lines; ++y) {
+      invalidate_row(y);
+    }
+  }
+}
+
+void im_output::append_number(unsigned value) {
+  char buffer[16];
+  auto const result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  buffer_.append(buffer, result.ptr);
+}
+
+void im_output::append_cursor_move(int x, int y) {
+  if (cursor_ == im_vec2(x, y)) {
+    return;
+  }
+  if (cursor_.y == y && cursor_.x >= 0 && cursor_.x < x) {
+    // CUF is shorter than CUP
+    buffer_ += "\x1b[";
+    if (auto const count = unsigned(x - cursor_.x); count > 1) {
+      this->append_number(count);
+    }
+    buffer_ += 'C';
+    return;
+  }
+  buffer_ += "\x1b[";
+  if (y > 0) {
+    this->append_number(unsigned(y + 1));
+  }
+  if (x > 0) {
+    buffer_ += ';';
+    this->append_number(unsigned(x + 1));
+  }
+  buffer_ += 'H';
+}
+
+void im_output::append_color(std::uint64_t attr, unsigned base) {
+  auto const rgb = attr & rgb_mask;
+  if (rgb == 0 && !(attr & TB_HI_BLACK)) {
+    // default color
+    this->append_number(base + 9);
+    buffer_ += ';';
+    return;
+  }
+
+  switch (mode_) {
+  case im_output_mode::truecolor:
+    this->append_number(base + 8);
+    buffer_ += ";2;";
+    this->append_number(unsigned(rgb >> 16) & 0xff);
+    buffer_ += ';';
+    this->append_number(unsigned(rgb >> 8) & 0xff);
+    buffer_ += ';';
+    this->append_number(unsigned(rgb) & 0xff);
+    break;
+  case im_output_mode::color256:
+    this->append_number(base + 8);
+    buffer_ += ";5;";
+    // TB_HI_BLACK stands for index 0
+    this->append_number(unsigned(rgb) & 0xff);
+    break;
+  case im_output_mode::color16:
+    // TB_BLACK..TB_WHITE are 1..8
+    this->append_number(base + (attr & TB_BRIGHT ? 60 : 0) + (unsigned(rgb) - 1) % 8);
+    break;
+  }
+  buffer_ += ';';
+}
+
+void im_output::append_sgr(im_style const& style) {
+  if (style == sgr_) [[likely]] {
+    return;
+  }
+
+  auto const mark = buffer_.size();
+  buffer_ += "\x1b[";
+
+  auto prev = sgr_;
+  auto const flags = style.fg & ~color_mask;
+  if ((prev.fg & ~color_mask) & ~flags) {
+    // there is no common "attribute off" code, start from scratch
+    buffer_ += "0;";
+    prev = im_style();
+  }
+  for (auto const& desc : sgr_attr_descs) {
+    if ((flags & desc.attr) && !(prev.fg & desc.attr)) {
+      this->append_number(desc.code);
+      buffer_ += ';';
+    }
+  }
+  if ((style.fg & color_mask) != (prev.fg & color_mask)) {
+    this->append_color(style.fg, 30);
+  }
+  if ((style.bg & color_mask) != (prev.bg & color_mask)) {
+    this->append_color(style.bg, 40);
+  }
+
+  if (buffer_.size() == mark + 2) [[unlikely]] {
+    // only non-color bits of background changed
+    buffer_.resize(mark);
+  } else {
+    buffer_.back() = 'm';
+  }
+  sgr_ = style;
+}
+
+void im_output::append_char(std::uint32_t ch) {
+  char buffer[8];
+  auto const length = ::tb_utf8_unicode_to_char(buffer, ch);
+  buffer_.append(buffer, std::size_t(std::max(length, 0)));
+}
+
+void im_output::flush() {
+  if (!write_all(fd_, buffer_)) [[unlikely]] {
+    // terminal state is unknown
+    invalid_ = true;
+    throw std::runtime_error(std::strerror(errno));
+  }
+}
+
+} // namespace xxx
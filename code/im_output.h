@@ -0,0 +1,134 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "im_palette.h"
+#include "im_style.h"
+#include "im_vec2.h"
+#include "xxx.h"
+
+namespace xxx {
+
+/// Query terminal support of synchronized output (DEC private mode 2026)
+/// Sends DECRQM request followed by DA1 request, DA1 is answered by every terminal,
+/// so its reply without DECRQM reply before means no support.
+/// \warning Should be called before terminal input is read by anyone else
+/// @param input receives bytes read along with replies (keys typed meanwhile) to be passed to input
+/// @return std::nullopt if there is no reply in time (late replies arrive with terminal input)
+[[nodiscard]] auto query_synchronized_output(int fd, std::chrono::milliseconds timeout, std::string& input)
+    -> std::optional<bool>;
+
+/// Terminal output backend
+///
+/// Frame is drawn into back buffer, present() compares it with cells already shown by terminal (front buffer)
+/// and emits changed cells only. Cursor is moved only on gaps between changed cells, SGR is emitted only on
+/// style change (in shortest form for output mode). Whole frame is sent by single write(),
+/// bracketed by synchronized output mode if terminal supports it, so terminal never shows partial frame.
+///
+/// Rows hashes of back buffer are updated on every cell change, so unchanged rows are skipped by comparing
+/// hashes and per cell comparison runs only for changed rows.
+///
+/// Vertical shift of rows between frames (scrolling list or log) is detected by rows hashes and sent as
+/// terminal scroll of region, so only rows appeared at the edge are written.
+class im_output {
+private:
+  // front buffer cell which never matches a drawn one (covered by wide character)
+  static constexpr auto invalid_ch = std::uint32_t(0xffffffff);
+  // minimal number of rows saved by terminal scroll
+  static constexpr auto scroll_min_rows = 2;
+
+  int fd_ = -1;
+  im_output_mode mode_ = im_output_mode::truecolor;
+  im_vec2 size_;
+  // cells shown by terminal
+  std::vector<im_cell> front_;
+  // cells of frame being drawn
+  std::vector<im_cell> back_;
+  // rows hashes of front and back buffers (back is updated incrementally)
+  std::vector<std::uint64_t> front_hashes_;
+  std::vector<std::uint64_t> back_hashes_;
+  // terminal contents are unknown, clear screen on next present()
+  bool invalid_ = true;
+  // wrap frame into synchronized output mode
+  bool synchronized_ = false;
+
+  // frame bytes
+  std::string buffer_;
+  // terminal cursor position (x < 0 - unknown)
+  im_vec2 cursor_;
+  // terminal current style
+  im_style sgr_;
+
+public:
+  im_output(im_output const&) = delete;
+  im_output& operator=(im_output const&) = delete;
+  im_output() = default;
+
+  /// Set terminal file descriptor
+  void set_fd(int fd) noexcept {
+    fd_ = fd;
+  }
+
+  /// Set terminal color capability (cell styles are expected to be mapped already)
+  void set_mode(im_output_mode mode) noexcept {
+    mode_ = mode;
+  }
+
+  /// Enable synchronized output (see query_synchronized_output(...))
+  void set_synchronized(bool value) noexcept {
+    synchronized_ = value;
+  }
+
+  /// Resize buffers, terminal is fully redrawn on size change
+  void resize(im_vec2 const& size);
+
+  /// Fill back buffer with blank cells
+  void clear(im_style const& style);
+
+  /// Set back buffer cell (out of screen cells are ignored)
+  void set_cell(int x, int y, std::uint32_t ch, im_style const& style) noexcept {
+    if (x < 0 || y < 0 || x >= size_.x || y >= size_.y) [[unlikely]] {
+      return;
+    }
+    auto& cell = back_[std::size_t(y) * size_.x + x];
+    auto const value = im_cell{.ch = ch, .style = style};
+    back_hashes_[y] ^= cell_hash(x, cell) ^ cell_hash(x, value);
+    cell = value;
+  }
+
+  /// Send back buffer changes to terminal
+  void present(im_frame_stats& stats);
+
+private:
+  // row hash is XOR of cells hashes (cell hash depends on column)
+  [[nodiscard]] static constexpr auto cell_hash(int x, im_cell const& cell) noexcept -> std::uint64_t {
+    auto value = cell.style.fg * 0x9e3779b97f4a7c15 ^ cell.style.bg * 0xc2b2ae3d27d4eb4f ^
+                 (std::uint64_t(cell.ch) << 16 | std::uint64_t(x));
+    // splitmix64 finalizer
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+  }
+
+  // hash of row filled with cell
+  [[nodiscard]] auto row_hash(im_cell const& cell) const noexcept -> std::uint64_t;
+
+  // detect vertical shift of rows and scroll terminal region
+  void scroll_rows();
+
+  void append_number(unsigned value);
+  void append_cursor_move(int x, int y);
+  void append_color(std::uint64_t attr, unsigned base);
+  void append_sgr(im_style const& style);
+  void append_char(std::uint32_t ch);
+  void flush();
+};
+
+} // namespace xxx
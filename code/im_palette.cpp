@@ -0,0 +1,133 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "im_palette.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <limits>
+#include <string_view>
+
+namespace xxx {
+namespace {
+
+struct rgb {
+  int r;
+  int g;
+  int b;
+};
+
+// xterm default ansi colors
+constexpr auto ansi16 = std::to_array<rgb>({
+    {0x00, 0x00, 0x00},
+    {0xcd, 0x00, 0x00},
+    {0x00, 0xcd, 0x00},
+    {0xcd, 0xcd, 0x00},
+    {0x00, 0x00, 0xee},
+    {0xcd, 0x00, 0xcd},
+    {0x00, 0xcd, 0xcd},
+    {0xe5, 0xe5, 0xe5},
+    {0x7f, 0x7f, 0x7f},
+    {0xff, 0x00, 0x00},
+    {0x00, 0xff, 0x00},
+    {0xff, 0xff, 0x00},
+    {0x5c, 0x5c, 0xff},
+    {0xff, 0x00, 0xff},
+    {0x00, 0xff, 0xff},
+    {0xff, 0xff, 0xff},
+});
+
+// xterm 6x6x6 color cube levels
+constexpr auto cube_levels = std::to_array<int>({0x00, 0x5f, 0x87, 0xaf, 0xd7, 0xff});
+
+[[nodiscard]] constexpr auto distance(rgb const& a, rgb const& b) noexcept -> int {
+  // weighted euclidean (eye is more sensitive to green)
+  auto const dr = a.r - b.r;
+  auto const dg = a.g - b.g;
+  auto const db = a.b - b.b;
+  return 2 * dr * dr + 4 * dg * dg + 3 * db * db;
+}
+
+[[nodiscard]] constexpr auto nearest_cube_level(int value) noexcept -> int {
+  auto result = 0;
+  for (int i = 1; i < int(cube_levels.size()); ++i) {
+    if (std::abs(cube_levels[i] - value) < std::abs(cube_levels[result] - value)) {
+      result = i;
+    }
+  }
+  return result;
+}
+
+// nearest color of xterm-256 palette (16..255, first 16 colors are user configured)
+[[nodiscard]] constexpr auto nearest_256(rgb const& color) noexcept -> std::uint8_t {
+  auto const r = nearest_cube_level(color.r);
+  auto const g = nearest_cube_level(color.g);
+  auto const b = nearest_cube_level(color.b);
+  auto const cube = rgb{cube_levels[r], cube_levels[g], cube_levels[b]};
+  auto const cube_index = 16 + 36 * r + 6 * g + b;
+
+  // grayscale ramp 232..255: 8, 18, ..., 238
+  auto const average = (color.r + color.g + color.b) / 3;
+  auto const gray_step = std::clamp((average - 3) / 10, 0, 23);
+  auto const gray_level = 8 + 10 * gray_step;
+  auto const gray = rgb{gray_level, gray_level, gray_level};
+
+  return distance(color, gray) < distance(color, cube) ? std::uint8_t(232 + gray_step) : std::uint8_t(cube_index);
+}
+
+[[nodiscard]] constexpr auto nearest_16(rgb const& color) noexcept -> std::uint8_t {
+  auto result = std::size_t(0);
+  auto best = std::numeric_limits<int>::max();
+  for (std::size_t i = 0; i < ansi16.size(); ++i) {
+    if (auto const d = distance(color, ansi16[i]); d < best) {
+      best = d;
+      result = i;
+    }
+  }
+  return std::uint8_t(result);
+}
+
+} // namespace
+
+auto detect_output_mode() noexcept -> im_output_mode {
+  auto const getenv = [](char const* name) {
+    auto const value = std::getenv(name);
+    return value ? std::string_view(value) : std::string_view();
+  };
+
+  auto const colorterm = getenv("COLORTERM");
+  if (colorterm == "truecolor" || colorterm == "24bit") {
+    return im_output_mode::truecolor;
+  }
+  auto const term = getenv("TERM");
+  if (term.contains("direct") || term.contains("truecolor")) {
+    return im_output_mode::truecolor;
+  }
+  if (term.contains("256color")) {
+    return im_output_mode::color256;
+  }
+  return im_output_mode::color16;
+}
+
+void im_palette::set_mode(im_output_mode mode) {
+  mode_ = mode;
+  if (mode_ == im_output_mode::truecolor) {
+    lut_.reset();
+    return;
+  }
+
+  if (!lut_) {
+    lut_ = std::make_unique_for_overwrite<std::uint8_t[]>(lut_size);
+  }
+  for (std::size_t key = 0; key < lut_size; ++key) {
+    // expand 5 bit channel to 8 bit
+    auto const expand = [](std::size_t value) {
+      return int((value << 3) | (value >> 2));
+    };
+    auto const color = rgb{expand((key >> 10) & 0x1f), expand((key >> 5) & 0x1f), expand(key & 0x1f)};
+    lut_[key] = mode_ == im_output_mode::color256 ? nearest_256(color) : nearest_16(color);
+  }
+}
+
+} // namespace xxx
@@ -0,0 +1,60 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include <termbox2.h>
+
+namespace xxx {
+
+/// Terminal color capability
+enum class im_output_mode { truecolor, color256, color16 };
+
+/// Detect terminal color capability from environment (COLORTERM, TERM)
+[[nodiscard]] auto detect_output_mode() noexcept -> im_output_mode;
+
+/// Map RGB colors to terminal palette
+///
+/// Colors are quantized to 15 bit and resolved through lookup table built once for output mode,
+/// so mapping is a single table load per color.
+class im_palette {
+private:
+  static constexpr auto lut_size = std::size_t(1) << 15;
+  static constexpr auto rgb_mask = std::uint64_t(0xffffff);
+
+  im_output_mode mode_ = im_output_mode::truecolor;
+  // 15 bit RGB -> palette index (xterm-256 or ansi-16)
+  std::unique_ptr<std::uint8_t[]> lut_;
+
+public:
+  im_palette() = default;
+
+  [[nodiscard]] auto mode() const noexcept -> im_output_mode {
+    return mode_;
+  }
+
+  /// Set output mode and build lookup table
+  void set_mode(im_output_mode mode);
+
+  /// Map termbox2 attribute (RGB color with attributes flags in upper bits) to output mode
+  /// Default color (zero) is kept as is
+  [[nodiscard]] auto map(std::uint64_t attr) const noexcept -> std::uint64_t {
+    auto const rgb = attr & rgb_mask;
+    if (mode_ == im_output_mode::truecolor || rgb == 0) [[likely]] {
+      return attr;
+    }
+    auto const key = ((rgb >> 9) & 0x7c00) | ((rgb >> 6) & 0x03e0) | ((rgb >> 3) & 0x001f);
+    auto const index = std::uint64_t(lut_[key]);
+    auto const flags = attr & ~rgb_mask;
+    if (mode_ == im_output_mode::color256) {
+      // zero is a default color in termbox2
+      return flags | (index == 0 ? TB_HI_BLACK : index);
+    }
+    return flags | ((index & 7) + TB_BLACK) | (index >= 8 ? TB_BRIGHT : 0);
+  }
+};
+
+} // namespace xxx
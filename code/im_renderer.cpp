@@ -27,11 +27,16 @@ void im_renderer::start_new_frame(im_rect const& clip_rect) {
   clip_rect_stack_.clear();
   clip_rect_ = clip_rect;
   viewport_offset_ = im_vec2(0, 0);
-  commands_.clear();
+
+  // previous storage is released by frame resource reset, reserve for same number of commands
+  auto const capacity = commands_.size();
+  commands_ = im_vector<render_cmd>(commands_.get_allocator());
+  commands_.reserve(capacity);
 }
 
-void im_renderer::render() {
-  ::tb_clear();
+void im_renderer::render(im_vec2 const& size, im_frame_stats& stats) {
+  output_.resize(size);
+  output_.clear(clear_style_);
 
   for (auto const& cmd : commands_) {
     switch (cmd.type) {
@@ -52,58 +57,71 @@ void im_renderer::render() {
     }
   }
 
-  ::tb_present();
+  output_.present(stats);
 }
 
 void im_renderer::do_fill_rect(render_cmd const& cmd) {
-  auto const& style = cmd.style;
+  auto const style = this->map_style(cmd.style);
   auto const& rect = cmd.fill_rect_data.rect;
   auto const& ch = cmd.fill_rect_data.ch;
 
   for (int pos_x : std::views::iota(rect.min.x, rect.max.x + 1)) {
     for (int pos_y : std::views::iota(rect.min.y, rect.max.y + 1)) {
-      ::tb_set_cell(pos_x, pos_y, ch, style.fg, style.bg);
+      output_.set_cell(pos_x, pos_y, ch, style);
     }
   }
 }
 
 void im_renderer::do_draw_rect(render_cmd const& cmd) {
-  auto const& style = cmd.style;
+  auto const style = this->map_style(cmd.style);
   auto const& rect = cmd.draw_rect_data.rect;
 
   for (auto const& [pos_x, pos_y, ch] : std::views::zip(std::views::iota(rect.min.x + 1, rect.max.x),
            std::views::repeat(rect.min.y), std::views::repeat(border_style[5]))) {
-    ::tb_set_cell(pos_x, pos_y, ch, style.fg, style.bg);
+    output_.set_cell(pos_x, pos_y, ch, style);
   }
   for (auto const& [pos_x, pos_y, ch] : std::views::zip(std::views::iota(rect.min.x + 1, rect.max.x),
            std::views::repeat(rect.max.y), std::views::repeat(border_style[5]))) {
-    ::tb_set_cell(pos_x, pos_y, ch, style.fg, style.bg);
+    output_.set_cell(pos_x, pos_y, ch, style);
   }
   for (auto const& [pos_x, pos_y, ch] : std::views::zip(std::views::repeat(rect.min.x),
            std::views::iota(rect.min.y + 1, rect.max.y), std::views::repeat(border_style[4]))) {
-    ::tb_set_cell(pos_x, pos_y, ch, style.fg, style.bg);
+    output_.set_cell(pos_x, pos_y, ch, style);
   }
   for (auto const& [pos_x, pos_y, ch] : std::views::zip(std::views::repeat(rect.max.x),
            std::views::iota(rect.min.y + 1, rect.max.y), std::views::repeat(border_style[4]))) {
-    ::tb_set_cell(pos_x, pos_y, ch, style.fg, style.bg);
+    output_.set_cell(pos_x, pos_y, ch, style);
   }
   auto const& top_left = rect.top_left();
-  ::tb_set_cell(top_left.x, top_left.y, border_style[0], style.fg, style.bg);
+  output_.set_cell(top_left.x, top_left.y, border_style[0], style);
   auto const& top_right = rect.top_right();
-  ::tb_set_cell(top_right.x, top_right.y, border_style[1], style.fg, style.bg);
+  output_.set_cell(top_right.x, top_right.y, border_style[1], style);
   auto const& bottom_left = rect.bottom_left();
-  ::tb_set_cell(bottom_left.x, bottom_left.y, border_style[2], style.fg, style.bg);
+  output_.set_cell(bottom_left.x, bottom_left.y, border_style[2], style);
   auto const& bottom_right = rect.bottom_right();
-  ::tb_set_cell(bottom_right.x, bottom_right.y, border_style[3], style.fg, style.bg);
+  output_.set_cell(bottom_right.x, bottom_right.y, border_style[3], style);
 }
 
 void im_renderer::do_draw_text(render_cmd const& cmd) {
-  auto const& style = cmd.style;
-  auto const& pos = cmd.draw_text_data.pos;
-  auto const& text = cmd.draw_text_data.text;
-
-  for (auto const& [pos_x, pos_y, ch] : std::views::zip(std::views::iota(pos.x), std::views::repeat(pos.y), text)) {
-    ::tb_set_cell(pos_x, pos_y, ch, style.fg, style.bg);
+  auto const style = this->map_style(cmd.style);
+  auto const& [pos, min_x, max_x, text] = cmd.draw_text_data;
+
+  // one cell per grapheme cluster (base character), wide one covers next cells
+  auto pos_x = pos.x;
+  for (auto rest = text; !rest.empty() && pos_x <= max_x;) {
+    auto const cluster = next_grapheme_cluster(rest);
+    if (pos_x >= min_x && pos_x + cluster.width - 1 <= max_x) {
+      for (int i = 0; i < cluster.width; ++i) {
+        output_.set_cell(pos_x + i, pos.y, i == 0 ? rest[0] : 0, style);
+      }
+    } else {
+      // wide character is cut by clip rect
+      for (int x = std::max(pos_x, min_x); x < std::min(pos_x + cluster.width, max_x + 1); ++x) {
+        output_.set_cell(x, pos.y, ' ', style);
+      }
+    }
+    pos_x += cluster.width;
+    rest = rest.subspan(cluster.length);
   }
 }
 
@@ -133,7 +151,8 @@ void im_renderer::do_draw_surface(render_cmd const& cmd) {
           std::views::drop(drop_y) | std::views::take(take_y)) {
     for (auto const& [pos_x, cell] :
         std::views::zip(std::views::iota(rect.min.x), line | std::views::drop(drop_x) | std::views::take(take_x))) {
-      ::tb_set_cell(pos_x, pos_y, cell.ch, cell.style.fg, cell.style.bg);
+      auto const style = this->map_style(cell.style);
+      output_.set_cell(pos_x, pos_y, cell.ch, style);
     }
   }
 }
@@ -11,8 +11,13 @@
 
 #include <termbox2.h>
 
+#include "im_memory_resource.h"
+#include "im_output.h"
+#include "im_palette.h"
 #include "im_stack.h"
+#include "im_style.h"
 #include "string_utils.h"
+#include "unicode.h"
 #include "xxx.h"
 
 #if 0
@@ -35,29 +40,6 @@ void debug(std::format_string<Ts...> fmt, Ts&&... args) {
 
 namespace xxx {
 
-struct im_style {
-  std::uint64_t fg = 0;
-  std::uint64_t bg = 0;
-
-  constexpr im_style() = default;
-  constexpr im_style(im_color color_fg, im_color color_bg = im_color()) noexcept : fg(color_fg), bg(color_bg) {}
-
-  [[nodiscard]] constexpr auto with_underline() const noexcept -> im_style {
-    return im_style(im_color(fg | TB_UNDERLINE), im_color(bg));
-  }
-  [[nodiscard]] constexpr auto with_reverse() const noexcept -> im_style {
-    return im_style(im_color(fg | TB_REVERSE), im_color(bg));
-  }
-  [[nodiscard]] constexpr auto with_blink() const noexcept -> im_style {
-    return im_style(im_color(fg | TB_BLINK), im_color(bg));
-  }
-};
-
-struct im_cell {
-  uint32_t ch;
-  im_style style;
-};
-
 enum class im_halign { left, center, right };
 enum class im_valign { top, center, bottom };
 
@@ -81,6 +63,9 @@ private:
 
   struct render_cmd_draw_text_data {
     im_vec2 pos;
+    // visible columns (characters are clipped by grapheme clusters)
+    int min_x;
+    int max_x;
     // non-owning value
     // should be alive until start_new_frame call
     std::span<std::uint32_t const> text;
@@ -105,16 +90,24 @@ private:
   };
   static_assert(std::is_trivially_copyable_v<render_cmd>);
 
-  im_stack<im_rect> clip_rect_stack_ = im_stack<im_rect>(32);
+  im_stack<im_rect> clip_rect_stack_;
   im_vec2 viewport_offset_;
   im_rect clip_rect_;
-  std::vector<render_cmd> commands_;
+  // allocated from frame resource, recreated on every frame
+  im_vector<render_cmd> commands_;
+  // output colors mapping
+  im_palette palette_;
+  im_style clear_style_;
+  im_output output_;
 
 public:
   im_renderer(im_renderer const&) = delete;
   im_renderer& operator=(im_renderer const&) = delete;
   im_renderer() = default;
 
+  /// @param resource is frame memory resource (reset before start_new_frame(...))
+  explicit im_renderer(std::pmr::memory_resource* resource) : commands_(resource) {}
+
   [[nodiscard]] auto viewport_offset() const noexcept -> im_vec2 const& {
     return viewport_offset_;
   }
@@ -131,6 +124,11 @@ public:
     return clip_rect_.contains(point - viewport_offset_);
   }
 
+  /// Get visible part of rect (screen coordinates)
+  [[nodiscard]] auto visible_rect(im_rect const& rect) const noexcept -> im_rect {
+    return clip_rect_.intersection(rect.translate(-viewport_offset_));
+  }
+
   [[nodiscard]] auto clip_rect() const noexcept -> im_rect const& {
     return clip_rect_;
   }
@@ -149,14 +147,31 @@ public:
   }
 
   void set_clear_color(im_style const& style) noexcept {
-    ::tb_set_clear_attrs(style.fg, style.bg);
+    clear_style_ = this->map_style(style);
+  }
+
+  /// Set terminal color capability (colors are converted on output)
+  void set_output_mode(im_output_mode mode) {
+    palette_.set_mode(mode);
+    output_.set_mode(mode);
+  }
+
+  /// Set terminal file descriptor for output
+  void set_output_fd(int fd) noexcept {
+    output_.set_fd(fd);
+  }
+
+  /// Enable synchronized output (terminal shows frame at once)
+  void set_output_synchronized(bool value) noexcept {
+    output_.set_synchronized(value);
   }
 
   /// Start drawing new frame
   void start_new_frame(im_rect const& clip_rect);
 
   /// Render frame
-  void render();
+  /// @param size is terminal size
+  void render(im_vec2 const& size, im_frame_stats& stats);
 
   /// Append command to fill rect
   void cmd_fill_rect(im_rect const& rect, std::uint32_t ch, im_style const& style) {
@@ -233,33 +248,37 @@ public:
   /// Append command to draw text at position
   /// \warning \c text must exists until next im_renderer::start_new_frame(...) call
   void cmd_draw_text_at(im_vec2 const& pos, std::span<std::uint32_t const> text, im_style const& style) {
-    if (text.empty()) {
+    this->cmd_draw_text_at(pos, text, xxx::text_width(text), style);
+  }
+
+  /// @overload
+  /// @param text_width is display width of text (see text_width(...))
+  void cmd_draw_text_at(
+      im_vec2 const& pos, std::span<std::uint32_t const> text, int text_width, im_style const& style) {
+    if (text_width <= 0) {
       return;
     }
 
-    auto const a_rect = this->adjust(im_rect(pos, pos + im_vec2(text.size() - 1, 0)));
+    auto const a_rect = this->adjust(im_rect(pos, pos + im_vec2(text_width - 1, 0)));
     auto const c_rect = clip_rect_.intersection(a_rect);
     if (!c_rect) {
       return;
     }
 
-    if (c_rect.min.x > a_rect.min.x) {
-      text = substr(text, c_rect.min.x - a_rect.min.x);
-    }
-    if (c_rect.max.x < a_rect.max.x) {
-      text = substr(text, 0, text.size() - (a_rect.max.x - c_rect.max.x));
-    }
-    if (text.empty()) {
-      return;
-    }
-
-    this->append_cmd_draw_text(c_rect.min, text, style);
+    this->append_cmd_draw_text(a_rect.min, c_rect.min.x, c_rect.max.x, text, style);
   }
 
   /// Append command to draw text inside rect
   /// \warning \c text must exists until next im_renderer::start_new_frame(...) call
   void cmd_draw_text_in_rect(im_rect const& rect, std::span<std::uint32_t const> text, im_style const& style,
       im_halign halign = im_halign::left, im_valign valign = im_valign::top) {
+    this->cmd_draw_text_in_rect(rect, text, xxx::text_width(text), style, halign, valign);
+  }
+
+  /// @overload
+  /// @param text_width is display width of text (see text_width(...))
+  void cmd_draw_text_in_rect(im_rect const& rect, std::span<std::uint32_t const> text, int text_width,
+      im_style const& style, im_halign halign = im_halign::left, im_valign valign = im_valign::top) {
     auto const a_rect = this->adjust(rect);
     auto const c_rect = clip_rect_.intersection(a_rect);
     if (!c_rect) {
@@ -267,7 +286,7 @@ public:
       return;
     }
 
-    auto const text_length = static_cast<int>(text.size());
+    auto const text_length = text_width;
     auto const rect_width = static_cast<int>(a_rect.width());
     auto const rect_height = static_cast<int>(a_rect.height());
 
@@ -302,19 +321,13 @@ public:
       text_min_x = a_rect.min.x + (rect_width - text_length);
       break;
     }
-    auto text_max_x = text_min_x + text_length - 1;
-
-    if (text_min_x < clip_rect_.min.x) {
-      text = substr(text, clip_rect_.min.x - text_min_x);
-      text_min_x = clip_rect_.min.x;
-    }
-    if (text_max_x > clip_rect_.max.x) {
-      text = substr(text, 0, text.size() - (text_max_x - clip_rect_.max.x));
-      text_max_x = clip_rect_.max.x;
-    }
+    auto const text_max_x = text_min_x + text_length - 1;
 
-    if (text_min_x <= text_max_x) {
-      this->append_cmd_draw_text(im_vec2(text_min_x, text_min_y), text, style);
+    // visible columns
+    auto const min_x = std::max(text_min_x, clip_rect_.min.x);
+    auto const max_x = std::min(text_max_x, clip_rect_.max.x);
+    if (min_x <= max_x) {
+      this->append_cmd_draw_text(im_vec2(text_min_x, text_min_y), min_x, max_x, text, style);
     }
   }
 
@@ -348,12 +361,15 @@ private:
     cmd.draw_rect_data = render_cmd_draw_rect_data{.rect = rect};
   }
 
-  void append_cmd_draw_text(im_vec2 const& pos, std::span<std::uint32_t const> text, im_style const& style) {
+  void append_cmd_draw_text(
+      im_vec2 const& pos, int min_x, int max_x, std::span<std::uint32_t const> text, im_style const& style) {
     auto& cmd = commands_.emplace_back();
     cmd.type = render_cmd_type::draw_text;
     cmd.style = style;
     cmd.draw_text_data = {};
     cmd.draw_text_data.pos = pos;
+    cmd.draw_text_data.min_x = min_x;
+    cmd.draw_text_data.max_x = max_x;
     cmd.draw_text_data.text = text;
   }
 
@@ -364,10 +380,18 @@ private:
     cmd.draw_surface_data = {.src_rect = src_rect, .rect = rect, .data = data};
   }
 
-  static void do_fill_rect(render_cmd const& cmd);
-  static void do_draw_rect(render_cmd const& cmd);
-  static void do_draw_text(render_cmd const& cmd);
-  static void do_draw_surface(render_cmd const& cmd);
+  // convert style colors to output mode
+  [[nodiscard]] auto map_style(im_style const& style) const noexcept -> im_style {
+    auto result = im_style();
+    result.fg = palette_.map(style.fg);
+    result.bg = palette_.map(style.bg);
+    return result;
+  }
+
+  void do_fill_rect(render_cmd const& cmd);
+  void do_draw_rect(render_cmd const& cmd);
+  void do_draw_text(render_cmd const& cmd);
+  void do_draw_surface(render_cmd const& cmd);
 };
 
 } // namespace xxx
@@ -0,0 +1,76 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace xxx {
+
+// bounded lock-free single-producer single-consumer queue
+template <typename T>
+  requires std::is_trivially_copyable_v<T>
+class im_spsc_queue {
+private:
+  static constexpr auto cache_line_size = std::size_t(64);
+
+  std::unique_ptr<T[]> data_;
+  std::size_t mask_ = 0;
+
+  // consumer position and cached producer position
+  alignas(cache_line_size) std::atomic<std::size_t> head_ = 0;
+  std::size_t tail_cache_ = 0;
+
+  // producer position and cached consumer position
+  alignas(cache_line_size) std::atomic<std::size_t> tail_ = 0;
+  std::size_t head_cache_ = 0;
+
+public:
+  im_spsc_queue(im_spsc_queue const&) = delete;
+  im_spsc_queue& operator=(im_spsc_queue const&) = delete;
+
+  // capacity is rounded up to power of two
+  explicit im_spsc_queue(std::size_t capacity) : mask_(std::bit_ceil(capacity) - 1) {
+    assert(capacity > 0);
+    data_ = std::make_unique_for_overwrite<T[]>(mask_ + 1);
+  }
+
+  [[nodiscard]] auto capacity() const noexcept -> std::size_t {
+    return mask_ + 1;
+  }
+
+  // producer side
+  [[nodiscard]] auto try_push(T const& value) noexcept -> bool {
+    auto const tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_cache_ > mask_) {
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if (tail - head_cache_ > mask_) {
+        return false;
+      }
+    }
+    data_[tail & mask_] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer side
+  [[nodiscard]] auto try_pop(T& value) noexcept -> bool {
+    auto const head = head_.load(std::memory_order_relaxed);
+    if (head == tail_cache_) {
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if (head == tail_cache_) {
+        return false;
+      }
+    }
+    value = data_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+} // namespace xxx
@@ -5,23 +5,34 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <memory>
 #include <utility>
 
 namespace xxx {
 
-template <typename T>
-  requires std::is_trivially_copyable_v<T>
+/// Number of im_stack growths past inline storage (instrumentation, reset by owner)
+inline std::size_t im_stack_grow_count = 0;
+
+/// Stack of trivially copyable values
+///
+/// First Inline values are kept inside object (no heap for common depth), stack grows geometrically
+/// on heap past it. Growth invalidates references to elements.
+template <typename T, std::size_t Inline = 32>
+  requires std::is_trivially_copyable_v<T> && (Inline > 0)
 class im_stack {
 private:
-  std::unique_ptr<T[]> data_;
-  std::size_t capacity_ = 0;
+  alignas(T) std::byte inline_[Inline * sizeof(T)];
+  std::unique_ptr<T[]> heap_;
+  T* data_ = reinterpret_cast<T*>(inline_);
+  std::size_t capacity_ = Inline;
   std::size_t size_ = 0;
 
 public:
-  constexpr im_stack(im_stack const& other) : capacity_(other.capacity_), size_(other.size_) {
-    data_ = std::make_unique_for_overwrite<T[]>(capacity_);
-    std::copy_n(other.data(), other.size(), data_.get());
+  constexpr im_stack(im_stack const& other) {
+    this->reserve(other.size_);
+    std::copy_n(other.data(), other.size(), data_);
+    size_ = other.size_;
   }
 
   constexpr im_stack& operator=(im_stack const& other) {
@@ -32,9 +43,16 @@ public:
     return *this;
   }
 
-  constexpr im_stack(im_stack&& other) noexcept
-      : data_(std::move(other.data_)), capacity_(std::exchange(other.capacity_, 0)),
-        size_(std::exchange(other.size_, 0)) {}
+  constexpr im_stack(im_stack&& other) noexcept : size_(std::exchange(other.size_, 0)) {
+    if (other.heap_) {
+      heap_ = std::move(other.heap_);
+      data_ = heap_.get();
+      capacity_ = std::exchange(other.capacity_, Inline);
+      other.data_ = reinterpret_cast<T*>(other.inline_);
+    } else {
+      std::copy_n(other.data_, size_, data_);
+    }
+  }
 
   constexpr im_stack& operator=(im_stack&& other) noexcept {
     if (this != &other) {
@@ -46,26 +64,34 @@ public:
 
   constexpr im_stack() = default;
 
-  constexpr im_stack(std::size_t capacity) : capacity_(capacity) {
-    assert(capacity > 0);
-    data_ = std::make_unique_for_overwrite<T[]>(capacity);
+  /// @param capacity is initial capacity (heap is allocated if it's above Inline)
+  constexpr im_stack(std::size_t capacity) {
+    this->reserve(capacity);
   }
 
   constexpr ~im_stack() = default;
 
-  constexpr void resize(std::size_t new_size) {
-    if (new_size > capacity_) {
-      throw std::bad_alloc();
+  constexpr void reserve(std::size_t new_capacity) {
+    if (new_capacity <= capacity_) {
+      return;
     }
+    auto heap = std::make_unique_for_overwrite<T[]>(new_capacity);
+    std::copy_n(data_, size_, heap.get());
+    heap_ = std::move(heap);
+    data_ = heap_.get();
+    capacity_ = new_capacity;
+  }
+
+  constexpr void resize(std::size_t new_size) {
+    this->grow_for(new_size);
     size_ = new_size;
   }
 
   constexpr void resize(std::size_t new_size, T const& value) {
-    if (new_size > capacity_) {
-      throw std::bad_alloc();
-    }
+    auto const copy = value;
+    this->grow_for(new_size);
     if (size_ < new_size) {
-      std::uninitialized_fill_n(this->data() + size_, new_size - size_, value);
+      std::uninitialized_fill_n(this->data() + size_, new_size - size_, copy);
     }
     size_ = new_size;
   }
@@ -97,11 +123,11 @@ public:
   }
 
   [[nodiscard]] constexpr auto data() const noexcept -> T const* {
-    return data_.get();
+    return data_;
   }
 
   [[nodiscard]] constexpr auto data() noexcept -> T* {
-    return data_.get();
+    return data_;
   }
 
   [[nodiscard]] constexpr auto begin() const noexcept -> T const* {
@@ -141,18 +167,17 @@ public:
   }
 
   constexpr void push_back(T const& value) {
-    if (size_ == capacity_) [[unlikely]] {
-      throw std::bad_alloc();
-    }
-    this->data()[size_++] = value;
+    // value may refer to element
+    auto const copy = value;
+    this->grow_for(size_ + 1);
+    this->data()[size_++] = copy;
   }
 
   template <typename... ArgsT>
   constexpr auto emplace_back(ArgsT&&... args) -> T& {
-    if (size_ == capacity_) [[unlikely]] {
-      throw std::bad_alloc();
-    }
-    this->data()[size_++] = T(std::forward<ArgsT>(args)...);
+    auto value = T(std::forward<ArgsT>(args)...);
+    this->grow_for(size_ + 1);
+    this->data()[size_++] = value;
     return this->back();
   }
 
@@ -160,6 +185,14 @@ public:
     assert(size_ > 0);
     size_--;
   }
+
+private:
+  constexpr void grow_for(std::size_t new_size) {
+    if (new_size > capacity_) [[unlikely]] {
+      im_stack_grow_count++;
+      this->reserve(std::max(new_size, capacity_ * 2));
+    }
+  }
 };
 
 } // namespace xxx
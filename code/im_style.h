@@ -0,0 +1,41 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+
+#include <termbox2.h>
+
+#include "im_color.h"
+
+namespace xxx {
+
+struct im_style {
+  std::uint64_t fg = 0;
+  std::uint64_t bg = 0;
+
+  constexpr im_style() = default;
+  constexpr im_style(im_color color_fg, im_color color_bg = im_color()) noexcept : fg(color_fg), bg(color_bg) {}
+
+  [[nodiscard]] constexpr auto with_underline() const noexcept -> im_style {
+    return im_style(im_color(fg | TB_UNDERLINE), im_color(bg));
+  }
+  [[nodiscard]] constexpr auto with_reverse() const noexcept -> im_style {
+    return im_style(im_color(fg | TB_REVERSE), im_color(bg));
+  }
+  [[nodiscard]] constexpr auto with_blink() const noexcept -> im_style {
+    return im_style(im_color(fg | TB_BLINK), im_color(bg));
+  }
+
+  constexpr auto operator==(im_style const&) const noexcept -> bool = default;
+};
+
+struct im_cell {
+  uint32_t ch;
+  im_style style;
+
+  constexpr auto operator==(im_cell const&) const noexcept -> bool = default;
+};
+
+} // namespace xxx
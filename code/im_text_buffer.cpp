@@ -0,0 +1,136 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "im_text_buffer.h"
+
+#include <algorithm>
+
+#include <termbox2.h>
+
+#include "unicode.h"
+
+namespace xxx {
+
+void im_text_buffer::assign(std::string_view str) {
+  utf8_to_unicode(str, data_);
+  gap_begin_ = data_.size();
+  data_.resize(data_.size() + min_gap_size);
+  gap_end_ = data_.size();
+  this->modified();
+}
+
+void im_text_buffer::clear() noexcept {
+  gap_begin_ = 0;
+  gap_end_ = data_.size();
+  this->modified();
+}
+
+void im_text_buffer::insert(std::size_t pos, std::uint32_t ch) {
+  assert(pos <= this->size());
+  this->reserve_gap(1);
+  this->move_gap(pos);
+  data_[gap_begin_++] = ch;
+  this->modified();
+}
+
+void im_text_buffer::insert(std::size_t pos, std::span<std::uint32_t const> text) {
+  assert(pos <= this->size());
+  if (text.empty()) {
+    return;
+  }
+  this->reserve_gap(text.size());
+  this->move_gap(pos);
+  std::copy(text.begin(), text.end(), data_.begin() + gap_begin_);
+  gap_begin_ += text.size();
+  this->modified();
+}
+
+void im_text_buffer::erase(std::size_t pos, std::size_t count) {
+  assert(pos <= this->size());
+  count = std::min(count, this->size() - pos);
+  if (count == 0) {
+    return;
+  }
+  this->move_gap(pos);
+  gap_end_ += count;
+  this->modified();
+}
+
+auto im_text_buffer::copy(std::size_t pos, std::size_t count, std::uint32_t* output) const noexcept -> std::size_t {
+  auto const size = this->size();
+  if (pos >= size) {
+    return 0;
+  }
+  count = std::min(count, size - pos);
+
+  auto const gap_size = gap_end_ - gap_begin_;
+  auto const first = data_.data();
+  auto const last = pos + count;
+
+  // part before gap
+  if (pos < gap_begin_) {
+    output = std::copy(first + pos, first + std::min(last, gap_begin_), output);
+  }
+  // part after gap
+  if (last > gap_begin_) {
+    auto const from = std::max(pos, gap_begin_);
+    std::copy(first + from + gap_size, first + last + gap_size, output);
+  }
+
+  return count;
+}
+
+auto im_text_buffer::str() const -> std::string const& {
+  if (!utf8_valid_) {
+    utf8_.clear();
+    auto const first = data_.data();
+    auto const append = [&](std::span<std::uint32_t const> input) {
+      char codepoint[7];
+      for (auto ch : input) {
+        auto const length = ::tb_utf8_unicode_to_char(codepoint, ch);
+        utf8_.append(codepoint, length);
+      }
+    };
+    append(std::span(first, gap_begin_));
+    append(std::span(first + gap_end_, data_.size() - gap_end_));
+    utf8_valid_ = true;
+  }
+  return utf8_;
+}
+
+void im_text_buffer::move_gap(std::size_t pos) noexcept {
+  assert(pos <= this->size());
+  auto const first = data_.begin();
+  if (pos < gap_begin_) {
+    // shift [pos, gap_begin) to the end of gap
+    std::copy_backward(first + pos, first + gap_begin_, first + gap_end_);
+    gap_end_ -= gap_begin_ - pos;
+    gap_begin_ = pos;
+  } else if (pos > gap_begin_) {
+    // shift [gap_end, gap_end + (pos - gap_begin)) to the start of gap
+    auto const count = pos - gap_begin_;
+    std::copy(first + gap_end_, first + gap_end_ + count, first + gap_begin_);
+    gap_begin_ += count;
+    gap_end_ += count;
+  }
+}
+
+void im_text_buffer::reserve_gap(std::size_t size) {
+  auto const gap_size = gap_end_ - gap_begin_;
+  if (gap_size >= size) [[likely]] {
+    return;
+  }
+
+  // grow geometrically to keep insertions amortized O(1)
+  auto const tail_size = data_.size() - gap_end_;
+  auto const new_gap_size = std::max({size, min_gap_size, data_.size() / 2});
+  auto const new_capacity = gap_begin_ + new_gap_size + tail_size;
+  data_.resize(new_capacity);
+
+  // move tail to the end of new storage
+  auto const first = data_.begin();
+  std::copy_backward(first + gap_end_, first + gap_end_ + tail_size, data_.end());
+  gap_end_ = new_capacity - tail_size;
+}
+
+} // namespace xxx
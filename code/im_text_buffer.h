@@ -0,0 +1,93 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xxx {
+
+/// Editable text storage (gap buffer of unicode code points)
+///
+/// Insert/erase near the previous edit position are O(1), UTF-8 representation
+/// is encoded on demand only (see im_text_buffer::str()).
+class im_text_buffer {
+private:
+  static constexpr auto min_gap_size = std::size_t(64);
+
+  std::vector<std::uint32_t> data_;
+  std::size_t gap_begin_ = 0;
+  std::size_t gap_end_ = 0;
+  std::uint64_t version_ = 0;
+
+  // utf8 representation cache
+  mutable std::string utf8_;
+  mutable bool utf8_valid_ = true;
+
+public:
+  im_text_buffer() = default;
+
+  explicit im_text_buffer(std::string_view str) {
+    this->assign(str);
+  }
+
+  /// Number of code points
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return data_.size() - (gap_end_ - gap_begin_);
+  }
+
+  [[nodiscard]] auto empty() const noexcept -> bool {
+    return this->size() == 0;
+  }
+
+  /// Modification counter, changed on every edit
+  [[nodiscard]] auto version() const noexcept -> std::uint64_t {
+    return version_;
+  }
+
+  [[nodiscard]] auto operator[](std::size_t i) const noexcept -> std::uint32_t {
+    assert(i < this->size());
+    return i < gap_begin_ ? data_[i] : data_[i + (gap_end_ - gap_begin_)];
+  }
+
+  /// Replace content with utf8 string
+  void assign(std::string_view str);
+
+  /// Remove all content
+  void clear() noexcept;
+
+  /// Insert code point at position
+  void insert(std::size_t pos, std::uint32_t ch);
+
+  /// Insert code points at position
+  void insert(std::size_t pos, std::span<std::uint32_t const> text);
+
+  /// Erase code points [pos, pos + count)
+  void erase(std::size_t pos, std::size_t count = 1);
+
+  /// Copy code points [pos, pos + count) into output
+  /// @return number of copied code points
+  auto copy(std::size_t pos, std::size_t count, std::uint32_t* output) const noexcept -> std::size_t;
+
+  /// Get content as utf8 string (encoded on first call after modification)
+  [[nodiscard]] auto str() const -> std::string const&;
+
+private:
+  // move gap start to pos
+  void move_gap(std::size_t pos) noexcept;
+
+  // ensure gap is at least size
+  void reserve_gap(std::size_t size);
+
+  void modified() noexcept {
+    version_++;
+    utf8_valid_ = false;
+  }
+};
+
+} // namespace xxx
@@ -0,0 +1,195 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "hash.h"
+#include "im_allocator.h"
+#include "unicode.h"
+
+namespace xxx {
+
+/// Decoded text with display width
+struct im_text_metrics {
+  std::span<std::uint32_t const> text;
+  int width = 0;
+  // hash of utf8 string (see im_text_cache::key(...)), std::nullopt - not hashed (layout isn't cached)
+  std::optional<std::uint32_t> hash = std::nullopt;
+};
+
+/// LRU cache of decoded and measured strings (keyed by hash of utf8 string)
+///
+/// Strings repeated across frames (labels, titles) skip decoding and measurement. Data is kept in
+/// long-lived arena, evicted entries release arena space only when arena is exhausted, all entries
+/// are dropped then on next frame start (so texts returned during a frame stay valid until its end).
+class im_text_cache {
+private:
+  static constexpr auto hash_seed = std::uint32_t(0x7e47ca3e);
+  static constexpr auto npos = std::numeric_limits<std::uint32_t>::max();
+
+  struct entry {
+    std::uint32_t hash = 0;
+    // LRU list, head is most recently used
+    std::uint32_t prev = npos;
+    std::uint32_t next = npos;
+    // key copy to resolve hash collision
+    std::string_view utf8;
+    im_text_metrics metrics;
+  };
+
+  std::size_t capacity_;
+  im_allocator arena_;
+  std::vector<entry> entries_;
+  // hash -> entry
+  std::unordered_map<std::uint32_t, std::uint32_t> index_;
+  std::uint32_t head_ = npos;
+  std::uint32_t tail_ = npos;
+  // arena exhausted, drop entries on next frame
+  bool full_ = false;
+
+  std::size_t hits_ = 0;
+  std::size_t misses_ = 0;
+
+public:
+  im_text_cache(im_text_cache const&) = delete;
+  im_text_cache& operator=(im_text_cache const&) = delete;
+
+  /// @param capacity is max number of entries
+  /// @param arena_capacity is arena size in bytes
+  explicit im_text_cache(std::size_t capacity = 1024, std::size_t arena_capacity = 256 * 1024)
+      : capacity_(capacity), arena_(arena_capacity) {
+    entries_.reserve(capacity_);
+    index_.reserve(capacity_);
+  }
+
+  /// Hash of utf8 string used as cache key
+  [[nodiscard]] static constexpr auto key(std::string_view utf8) noexcept -> std::uint32_t {
+    return hash(utf8, hash_seed);
+  }
+
+  /// Number of lookups found in cache since last reset_stats()
+  [[nodiscard]] auto hits() const noexcept -> std::size_t {
+    return hits_;
+  }
+
+  /// Number of lookups decoded and measured since last reset_stats()
+  [[nodiscard]] auto misses() const noexcept -> std::size_t {
+    return misses_;
+  }
+
+  void reset_stats() noexcept {
+    hits_ = 0;
+    misses_ = 0;
+  }
+
+  /// Start new frame (texts returned during previous frame are not used anymore)
+  void new_frame() {
+    if (full_) [[unlikely]] {
+      this->clear();
+    }
+  }
+
+  /// Drop all entries
+  void clear() {
+    arena_.reset();
+    entries_.clear();
+    index_.clear();
+    head_ = npos;
+    tail_ = npos;
+    full_ = false;
+  }
+
+  /// Get text metrics, decode and measure text on miss
+  /// @return nullopt if text is not cached and arena is exhausted
+  [[nodiscard]] auto get(std::string_view utf8) -> std::optional<im_text_metrics> {
+    auto const text_hash = key(utf8);
+    if (auto const metrics = this->find(text_hash, utf8); metrics) [[likely]] {
+      return metrics;
+    }
+    misses_++;
+    return this->insert(text_hash, utf8);
+  }
+
+private:
+  [[nodiscard]] auto find(std::uint32_t text_hash, std::string_view utf8) -> std::optional<im_text_metrics> {
+    auto const found = index_.find(text_hash);
+    if (found == index_.end() || entries_[found->second].utf8 != utf8) {
+      return std::nullopt;
+    }
+    this->touch(found->second);
+    hits_++;
+    return entries_[found->second].metrics;
+  }
+
+  [[nodiscard]] auto insert(std::uint32_t text_hash, std::string_view utf8) -> std::optional<im_text_metrics> {
+    auto const decoded = utf8_to_unicode(utf8);
+    auto const utf8_copy = arena_.allocate<char>(utf8.size());
+    auto const text_copy = arena_.allocate<std::uint32_t>(decoded.size());
+    if ((!utf8_copy && !utf8.empty()) || (!text_copy && !decoded.empty())) [[unlikely]] {
+      full_ = true;
+      return std::nullopt;
+    }
+    std::memcpy(utf8_copy, utf8.data(), utf8.size());
+    std::memcpy(text_copy, decoded.data(), decoded.size_bytes());
+
+    auto id = npos;
+    if (auto const found = index_.find(text_hash); found != index_.end()) {
+      // hash collision, replace entry
+      id = found->second;
+      this->unlink(id);
+    } else if (entries_.size() < capacity_) {
+      id = std::uint32_t(entries_.size());
+      entries_.emplace_back();
+      index_.emplace(text_hash, id);
+    } else {
+      // evict least recently used
+      id = tail_;
+      this->unlink(id);
+      index_.erase(entries_[id].hash);
+      index_.emplace(text_hash, id);
+    }
+
+    auto& e = entries_[id];
+    e.hash = text_hash;
+    e.utf8 = std::string_view(utf8_copy, utf8.size());
+    e.metrics.text = std::span<std::uint32_t const>(text_copy, decoded.size());
+    e.metrics.width = text_width(e.metrics.text);
+    e.metrics.hash = text_hash;
+    this->link_front(id);
+    return e.metrics;
+  }
+
+  void unlink(std::uint32_t id) noexcept {
+    auto& e = entries_[id];
+    (e.prev != npos ? entries_[e.prev].next : head_) = e.next;
+    (e.next != npos ? entries_[e.next].prev : tail_) = e.prev;
+    e.prev = npos;
+    e.next = npos;
+  }
+
+  void link_front(std::uint32_t id) noexcept {
+    auto& e = entries_[id];
+    e.prev = npos;
+    e.next = head_;
+    (head_ != npos ? entries_[head_].prev : tail_) = id;
+    head_ = id;
+  }
+
+  void touch(std::uint32_t id) noexcept {
+    if (head_ != id) {
+      this->unlink(id);
+      this->link_front(id);
+    }
+  }
+};
+
+} // namespace xxx
@@ -0,0 +1,159 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "im_text_buffer.h"
+#include "im_vec2.h"
+
+namespace xxx {
+
+/// Multi-line text editor state (kept per widget id)
+///
+/// Holds cached line index of the edited buffer. Index is updated in-place on edits made
+/// through the state and rebuilt only when buffer was modified from the outside.
+///
+/// Line index is a gap buffer placed after the edited line: starts of lines before the gap are offsets
+/// from text begin, starts of lines after the gap are offsets from text end. An edit doesn't change
+/// lines after it, only lines moved across the gap are converted, so typing costs O(1).
+struct im_text_editor_state {
+  // buffer version line index was built for
+  std::uint64_t version = std::numeric_limits<std::uint64_t>::max();
+  // line starts with gap [gap_begin, gap_end), first line always starts at 0
+  std::vector<std::size_t> line_starts = {0};
+  std::size_t gap_begin = 1;
+  std::size_t gap_end = 1;
+  // text size line index was built for
+  std::size_t text_size = 0;
+  // cursor offset in buffer
+  std::size_t cursor = 0;
+  // preferred cursor column on moving between lines
+  std::size_t cursor_column = 0;
+  // first visible column and line
+  im_vec2 scroll;
+
+  /// Rebuild line index if buffer was modified outside of editor
+  void sync(im_text_buffer const& buffer) {
+    if (version == buffer.version()) [[likely]] {
+      return;
+    }
+
+    line_starts.assign(1, 0);
+    for (std::size_t i = 0, size = buffer.size(); i < size; ++i) {
+      if (buffer[i] == '\n') {
+        line_starts.push_back(i + 1);
+      }
+    }
+    gap_begin = line_starts.size();
+    gap_end = line_starts.size();
+    text_size = buffer.size();
+    cursor = std::min(cursor, buffer.size());
+    version = buffer.version();
+  }
+
+  [[nodiscard]] auto line_count() const noexcept -> std::size_t {
+    return line_starts.size() - (gap_end - gap_begin);
+  }
+
+  /// Get line index of buffer offset
+  [[nodiscard]] auto line_of(std::size_t offset) const noexcept -> std::size_t {
+    // last line started at or before offset
+    auto first = std::size_t(0);
+    auto count = this->line_count();
+    while (count > 1) {
+      auto const half = count / 2;
+      if (this->line_begin(first + half) <= offset) {
+        first += half;
+        count -= half;
+      } else {
+        count = half;
+      }
+    }
+    return first;
+  }
+
+  /// Get offset of line start
+  [[nodiscard]] auto line_begin(std::size_t line) const noexcept -> std::size_t {
+    return line < gap_begin ? line_starts[line] : text_size - line_starts[line + (gap_end - gap_begin)];
+  }
+
+  /// Get offset of line end (line break excluded)
+  [[nodiscard]] auto line_end(im_text_buffer const& buffer, std::size_t line) const noexcept -> std::size_t {
+    return line + 1 < this->line_count() ? this->line_begin(line + 1) - 1 : buffer.size();
+  }
+
+  /// Insert text at cursor and move cursor after it
+  void insert(im_text_buffer& buffer, std::span<std::uint32_t const> text) {
+    auto const pos = cursor;
+
+    buffer.insert(pos, text);
+
+    // following lines keep offsets from text end, inserted lines go into gap
+    this->move_gap(this->line_of(pos) + 1);
+    if (auto const count = std::size_t(std::ranges::count(text, std::uint32_t('\n'))); count > 0) {
+      this->reserve_gap(count);
+      for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') {
+          line_starts[gap_begin++] = pos + i + 1;
+        }
+      }
+    }
+    text_size += text.size();
+
+    cursor = pos + text.size();
+    version = buffer.version();
+  }
+
+  /// Erase text [pos, pos + count)
+  void erase(im_text_buffer& buffer, std::size_t pos, std::size_t count) {
+    count = std::min(count, buffer.size() - std::min(pos, buffer.size()));
+    if (count == 0) {
+      return;
+    }
+
+    buffer.erase(pos, count);
+
+    // drop lines started inside erased range, following lines keep offsets from text end
+    this->move_gap(this->line_of(pos) + 1);
+    while (gap_end < line_starts.size() && text_size - line_starts[gap_end] <= pos + count) {
+      gap_end++;
+    }
+    text_size -= count;
+
+    if (cursor > pos) {
+      cursor = cursor >= pos + count ? cursor - count : pos;
+    }
+    version = buffer.version();
+  }
+
+private:
+  // move gap to line index (lines crossing gap are converted between offsets from begin and end)
+  void move_gap(std::size_t line) noexcept {
+    while (gap_begin > line) {
+      line_starts[--gap_end] = text_size - line_starts[--gap_begin];
+    }
+    while (gap_begin < line) {
+      line_starts[gap_begin++] = text_size - line_starts[gap_end++];
+    }
+  }
+
+  // make room for count lines in gap
+  void reserve_gap(std::size_t count) {
+    if (gap_end - gap_begin >= count) [[likely]] {
+      return;
+    }
+    auto const tail = line_starts.size() - gap_end;
+    auto const gap = std::max(count, line_starts.size() / 2 + 16);
+    line_starts.resize(gap_begin + gap + tail);
+    std::ranges::copy_backward(std::span(line_starts).subspan(gap_end, tail), line_starts.end());
+    gap_end = gap_begin + gap;
+  }
+};
+
+} // namespace xxx
@@ -0,0 +1,90 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "im_text_layout.h"
+
+#include <algorithm>
+
+#include "unicode.h"
+
+namespace xxx {
+
+void wrap_text(std::span<std::uint32_t const> text, int width, std::vector<im_text_line>& output) {
+  static constexpr auto npos = std::uint32_t(-1);
+
+  width = std::max(width, 1);
+
+  auto line = im_text_line();
+  // last space of current line and line width before it
+  auto space_pos = npos;
+  auto space_width = 0;
+
+  auto const break_line = [&](std::uint32_t end, std::uint32_t next_begin, int line_width) {
+    output.push_back(im_text_line{.begin = line.begin, .end = end, .width = line_width});
+    line.width -= line_width + int(next_begin - end);
+    line.begin = next_begin;
+    space_pos = npos;
+  };
+
+  auto pos = std::uint32_t(0);
+  while (pos < text.size()) {
+    auto const ch = text[pos];
+    if (ch == '\n') {
+      break_line(pos, pos + 1, line.width);
+      line.width = 0;
+      pos++;
+      continue;
+    }
+
+    auto const cluster = next_grapheme_cluster(text.subspan(pos));
+    if (ch == ' ') {
+      if (line.width + cluster.width > width) {
+        // break at overflowing space, it's dropped
+        break_line(pos, pos + 1, line.width);
+        line.width = 0;
+        pos++;
+        continue;
+      }
+      space_pos = pos;
+      space_width = line.width;
+    } else if (line.width > 0 && line.width + cluster.width > width) {
+      if (space_pos != npos) {
+        // move last word to next line, space between is dropped
+        break_line(space_pos, space_pos + 1, space_width);
+      } else {
+        // word doesn't fit into line
+        break_line(pos, pos, line.width);
+      }
+      continue;
+    }
+
+    line.width += cluster.width;
+    pos += std::uint32_t(cluster.length);
+  }
+
+  line.end = std::uint32_t(text.size());
+  output.push_back(line);
+}
+
+auto truncate_text(std::span<std::uint32_t const> text, int text_width, int width) noexcept -> im_text_line {
+  if (text_width <= width) {
+    return im_text_line{.begin = 0, .end = std::uint32_t(text.size()), .width = text_width};
+  }
+  if (width <= 0) {
+    return im_text_line();
+  }
+
+  // keep last column for ellipsis
+  auto result = im_text_line{.begin = 0, .end = 0, .width = 0, .ellipsis = true};
+  while (result.end < text.size()) {
+    auto const cluster = next_grapheme_cluster(text.subspan(result.end));
+    if (result.width + cluster.width > width - 1) {
+      break;
+    }
+    result.width += cluster.width;
+    result.end += std::uint32_t(cluster.length);
+  }
+  return result;
+}
+
+} // namespace xxx
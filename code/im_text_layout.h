@@ -0,0 +1,129 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace xxx {
+
+/// Line of laid out text
+struct im_text_line {
+  // code points range [begin, end)
+  std::uint32_t begin = 0;
+  std::uint32_t end = 0;
+  // display width (without ellipsis)
+  int width = 0;
+  // line is truncated, ellipsis follows
+  bool ellipsis = false;
+};
+
+/// Text overflow handling
+enum class im_text_overflow { wrap, ellipsis };
+
+/// Glyph shown at the end of truncated line
+inline constexpr auto im_ellipsis_ch = std::uint32_t(L'…');
+
+/// Break text into lines not wider than width at spaces (word longer than width is broken at any character)
+/// Line feed starts new line. Lines are appended to output.
+void wrap_text(std::span<std::uint32_t const> text, int width, std::vector<im_text_line>& output);
+
+/// Truncate text to width, tail is replaced with ellipsis if text doesn't fit
+/// @param text_width is display width of text
+[[nodiscard]] auto truncate_text(std::span<std::uint32_t const> text, int text_width, int width) noexcept
+    -> im_text_line;
+
+/// Cache of text lines per text hash, width and overflow mode
+///
+/// Stable texts (wrapped paragraphs) are laid out once, after that it's a single lookup per frame.
+/// Lines are kept in single buffer, cache is dropped on next frame start when buffer is exhausted.
+class im_text_layout_cache {
+private:
+  struct key {
+    std::uint32_t hash;
+    std::uint32_t length;
+    int width;
+    im_text_overflow overflow;
+
+    constexpr auto operator==(key const&) const noexcept -> bool = default;
+  };
+
+  struct key_hash {
+    [[nodiscard]] auto operator()(key const& value) const noexcept -> std::size_t {
+      auto const result = (std::uint64_t(value.hash) << 32) ^ (std::uint64_t(value.length) << 16) ^
+                          (std::uint64_t(value.width) << 1) ^ std::uint64_t(value.overflow);
+      return std::size_t(result * 0x9e3779b97f4a7c15);
+    }
+  };
+
+  struct lines_range {
+    std::uint32_t offset;
+    std::uint32_t count;
+  };
+
+  std::size_t max_lines_;
+  std::unordered_map<key, lines_range, key_hash> index_;
+  std::vector<im_text_line> lines_;
+  // lines of text not fitted into cache
+  std::vector<im_text_line> scratch_;
+  // buffer exhausted, drop cache on next frame
+  bool full_ = false;
+
+public:
+  im_text_layout_cache(im_text_layout_cache const&) = delete;
+  im_text_layout_cache& operator=(im_text_layout_cache const&) = delete;
+
+  /// @param max_lines is max number of cached lines
+  explicit im_text_layout_cache(std::size_t max_lines = 16 * 1024) : max_lines_(max_lines) {
+    lines_.reserve(max_lines_);
+  }
+
+  /// Start new frame
+  void new_frame() {
+    if (full_) [[unlikely]] {
+      index_.clear();
+      lines_.clear();
+      full_ = false;
+    }
+  }
+
+  /// Get text lines
+  /// @param hash is hash of text (i.e. im_text_metrics::hash), std::nullopt - layout isn't cached
+  /// @param text_width is display width of text
+  /// @return lines valid until next get(...) call
+  [[nodiscard]] auto get(std::optional<std::uint32_t> hash, std::span<std::uint32_t const> text, int text_width,
+      int width, im_text_overflow overflow) -> std::span<im_text_line const> {
+    auto const k =
+        key{.hash = hash.value_or(0), .length = std::uint32_t(text.size()), .width = width, .overflow = overflow};
+    if (hash) [[likely]] {
+      if (auto const found = index_.find(k); found != index_.end()) [[likely]] {
+        return std::span(lines_).subspan(found->second.offset, found->second.count);
+      }
+    }
+
+    scratch_.clear();
+    if (overflow == im_text_overflow::wrap) {
+      wrap_text(text, width, scratch_);
+    } else {
+      scratch_.push_back(truncate_text(text, text_width, width));
+    }
+
+    if (!hash) {
+      return scratch_;
+    }
+    if (lines_.size() + scratch_.size() > max_lines_) [[unlikely]] {
+      full_ = true;
+      return scratch_;
+    }
+    auto const offset = std::uint32_t(lines_.size());
+    lines_.insert(lines_.end(), scratch_.begin(), scratch_.end());
+    index_.emplace(k, lines_range{.offset = offset, .count = std::uint32_t(scratch_.size())});
+    return std::span(lines_).subspan(offset, scratch_.size());
+  }
+};
+
+} // namespace xxx
@@ -3,28 +3,114 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstdint>
 
 #include "xxx.h"
 
 #include "im_stack.h"
+#include "im_style.h"
 
 namespace xxx {
 
+/// Style ids (foreground and background color pairs used by widgets)
+enum class im_style_id {
+  text,
+  border,
+  view_inactive_border,
+  view_inactive_title,
+  view_active_border,
+  view_active_title,
+  button_inactive_background,
+  button_inactive_text,
+  button_inactive_fx,
+  button_active_background,
+  button_active_text,
+  button_active_fx,
+  input_inactive_background,
+  input_inactive_text,
+  input_inactive_prompt,
+  input_inactive_placeholder,
+  input_active_background,
+  input_active_text,
+  input_active_prompt,
+  input_active_placeholder,
+
+  last
+};
+
 class im_theme {
 private:
   static constexpr auto max_color_states = static_cast<std::size_t>(im_color_id::last);
+  static constexpr auto max_styles = static_cast<std::size_t>(im_style_id::last);
 
   struct color_state {
     im_color_id id;
     im_color color;
   };
 
-  im_stack<color_state> state_stack_ = im_stack<color_state>(32);
+  struct style_desc {
+    im_style_id id;
+    // im_color_id::last - default color
+    im_color_id fg;
+    im_color_id bg;
+  };
+
+  static constexpr auto style_descs = std::to_array<style_desc>({
+      {im_style_id::text, im_color_id::text, im_color_id::background},
+      {im_style_id::border, im_color_id::border, im_color_id::background},
+      {im_style_id::view_inactive_border, im_color_id::view_inactive_border, im_color_id::background},
+      {im_style_id::view_inactive_title, im_color_id::view_inactive_title, im_color_id::background},
+      {im_style_id::view_active_border, im_color_id::view_active_border, im_color_id::background},
+      {im_style_id::view_active_title, im_color_id::view_active_title, im_color_id::background},
+      {im_style_id::button_inactive_background, im_color_id::last, im_color_id::button_inactive_background},
+      {im_style_id::button_inactive_text, im_color_id::button_inactive_text, im_color_id::button_inactive_background},
+      {im_style_id::button_inactive_fx, im_color_id::button_inactive_fx, im_color_id::button_inactive_background},
+      {im_style_id::button_active_background, im_color_id::last, im_color_id::button_active_background},
+      {im_style_id::button_active_text, im_color_id::button_active_text, im_color_id::button_active_background},
+      {im_style_id::button_active_fx, im_color_id::button_active_fx, im_color_id::button_active_background},
+      {im_style_id::input_inactive_background, im_color_id::last, im_color_id::input_inactive_background},
+      {im_style_id::input_inactive_text, im_color_id::input_inactive_text, im_color_id::input_inactive_background},
+      {im_style_id::input_inactive_prompt, im_color_id::input_inactive_prompt, im_color_id::input_inactive_background},
+      {im_style_id::input_inactive_placeholder, im_color_id::input_placeholder, im_color_id::input_inactive_background},
+      {im_style_id::input_active_background, im_color_id::last, im_color_id::input_active_background},
+      {im_style_id::input_active_text, im_color_id::input_active_text, im_color_id::input_active_background},
+      {im_style_id::input_active_prompt, im_color_id::input_active_prompt, im_color_id::input_active_background},
+      {im_style_id::input_active_placeholder, im_color_id::input_placeholder, im_color_id::input_active_background},
+  });
+
+  static_assert(style_descs.size() == max_styles);
+  static_assert(std::ranges::is_sorted(style_descs, {}, &style_desc::id) &&
+                    std::ranges::adjacent_find(style_descs, {}, &style_desc::id) == style_descs.end(),
+      "im_theme::style_descs must be ordered by style id");
+  static_assert(max_styles <= 32);
+
+  // styles to update on color change (bit per style id)
+  static constexpr auto style_dependents = [] {
+    auto result = std::array<std::uint32_t, max_color_states>();
+    for (std::size_t i = 0; i < style_descs.size(); ++i) {
+      if (style_descs[i].fg != im_color_id::last) {
+        result[static_cast<std::size_t>(style_descs[i].fg)] |= std::uint32_t(1) << i;
+      }
+      result[static_cast<std::size_t>(style_descs[i].bg)] |= std::uint32_t(1) << i;
+    }
+    return result;
+  }();
+
+  im_stack<color_state> state_stack_;
   std::array<im_color, max_color_states> colors_;
+  // styles compiled from colors_
+  std::array<im_style, max_styles> styles_;
 
 public:
   im_theme() {
+    this->reset_default_colors();
+  }
+
+  /// Restore built-in default colors
+  void reset_default_colors() noexcept {
     // https://coolors.co/palette/848c8e-435058-dcf763-bfb7b6-f1f2ee
 
     this->set_default_color(im_color_id::text, {});
@@ -52,6 +138,11 @@ public:
     this->set_default_color(im_color_id::input_placeholder, 0x848c8e_c);
   }
 
+  [[nodiscard]] auto get_style(im_style_id id) const noexcept -> im_style const& {
+    assert(id < im_style_id::last);
+    return styles_[static_cast<std::size_t>(id)];
+  }
+
   [[nodiscard]] auto get_style(im_color_id fg_id, im_color_id bg_id) const noexcept -> im_style {
     return im_style(this->get_color(fg_id), this->get_color(bg_id));
   }
@@ -66,12 +157,14 @@ public:
     assert(id < im_color_id::last);
     auto const index = static_cast<std::size_t>(id);
     colors_[index] = color;
+    this->update_styles(index);
   }
 
   void push_color(im_color_id id, im_color color) {
     assert(id < im_color_id::last);
     auto const index = static_cast<std::size_t>(id);
     state_stack_.emplace_back(id, std::exchange(colors_[index], color));
+    this->update_styles(index);
   }
 
   void pop_color(std::size_t cnt = 1) {
@@ -79,12 +172,23 @@ public:
       auto const index = static_cast<std::size_t>(state_stack_.back().id);
       colors_[index] = state_stack_.back().color;
       state_stack_.pop_back();
+      this->update_styles(index);
     }
   }
 
   void reset() noexcept {
     pop_color(99999);
   }
+
+private:
+  // recompile styles which use color
+  void update_styles(std::size_t color_index) noexcept {
+    for (auto mask = style_dependents[color_index]; mask != 0; mask &= mask - 1) {
+      auto const& desc = style_descs[std::countr_zero(mask)];
+      styles_[static_cast<std::size_t>(desc.id)] = im_style(
+          desc.fg != im_color_id::last ? this->get_color(desc.fg) : im_color(), this->get_color(desc.bg));
+    }
+  }
 };
 
 } // namespace xxx
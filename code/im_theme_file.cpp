@@ -0,0 +1,167 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#include "im_theme_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+
+#include <fcntl.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace xxx {
+namespace {
+
+[[nodiscard]] constexpr auto trim(std::string_view str) noexcept -> std::string_view {
+  constexpr auto spaces = std::string_view(" \t\r");
+  auto const first = str.find_first_not_of(spaces);
+  if (first == str.npos) {
+    return std::string_view();
+  }
+  return str.substr(first, str.find_last_not_of(spaces) - first + 1);
+}
+
+[[nodiscard]] auto parse_color(std::string_view value) noexcept -> std::optional<im_color> {
+  if (value == "default") {
+    return im_color();
+  }
+  if (!value.starts_with("0x") && !value.starts_with("0X")) {
+    return std::nullopt;
+  }
+  value.remove_prefix(2);
+  if (value.size() != 6) {
+    return std::nullopt;
+  }
+  auto result = std::uint32_t(0);
+  auto const [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result, 16);
+  if (ec != std::errc() || ptr != value.data() + value.size()) {
+    return std::nullopt;
+  }
+  return im_color(result);
+}
+
+} // namespace
+
+auto im_theme_file::open(std::string_view path, bool watch) -> bool {
+  this->close();
+
+  path_ = path;
+  auto const slash = path_.rfind('/');
+  filename_ = slash == path_.npos ? std::string_view(path_) : std::string_view(path_).substr(slash + 1);
+
+  if (!watch) {
+    return true;
+  }
+
+  inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotify_fd_ < 0) {
+    return false;
+  }
+  auto const dir = slash == path_.npos ? std::string(".") : slash == 0 ? std::string("/") : path_.substr(0, slash);
+  if (::inotify_add_watch(inotify_fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+    this->close();
+    return false;
+  }
+  return true;
+}
+
+void im_theme_file::close() noexcept {
+  if (inotify_fd_ >= 0) {
+    ::close(inotify_fd_);
+    inotify_fd_ = -1;
+  }
+}
+
+auto im_theme_file::read(colors& output) noexcept -> bool {
+  auto const fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  // read until EOF instead of trusting file size, file may be rewritten meanwhile
+  auto size = std::size_t(0);
+  while (true) {
+    // one extra byte detects file larger than buffer
+    char overflow;
+    auto const rc = size < buffer_.size() ? ::read(fd, buffer_.data() + size, buffer_.size() - size)
+                                          : ::read(fd, &overflow, 1);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0 || (rc > 0 && size == buffer_.size())) {
+      ::close(fd);
+      return false;
+    }
+    if (rc == 0) {
+      break;
+    }
+    size += static_cast<std::size_t>(rc);
+  }
+  ::close(fd);
+
+  return parse(std::string_view(buffer_.data(), size), output);
+}
+
+auto im_theme_file::changed() noexcept -> bool {
+  if (inotify_fd_ < 0) {
+    return false;
+  }
+
+  auto result = false;
+  alignas(::inotify_event) char buffer[4096];
+  while (true) {
+    auto const rc = ::read(inotify_fd_, buffer, sizeof(buffer));
+    if (rc <= 0) {
+      // EAGAIN - no more events
+      break;
+    }
+    for (auto ptr = buffer; ptr < buffer + rc;) {
+      auto const event = reinterpret_cast<::inotify_event const*>(ptr);
+      if (event->len > 0 && std::string_view(event->name) == filename_) {
+        result = true;
+      }
+      ptr += sizeof(::inotify_event) + event->len;
+    }
+  }
+  return result;
+}
+
+auto im_theme_file::parse(std::string_view content, colors& output) noexcept -> bool {
+  auto result = colors();
+
+  while (!content.empty()) {
+    auto const eol = content.find('\n');
+    auto line = content.substr(0, eol);
+    content = eol == content.npos ? std::string_view() : content.substr(eol + 1);
+
+    if (auto const comment = line.find('#'); comment != line.npos) {
+      line = line.substr(0, comment);
+    }
+    line = trim(line);
+    if (line.empty()) {
+      continue;
+    }
+
+    auto const eq = line.find('=');
+    if (eq == line.npos) {
+      return false;
+    }
+    auto const name = trim(line.substr(0, eq));
+    auto const found = std::ranges::find(im_color_names, name);
+    if (found == im_color_names.end()) {
+      return false;
+    }
+    auto const color = parse_color(trim(line.substr(eq + 1)));
+    if (!color) {
+      return false;
+    }
+    result[std::size_t(found - im_color_names.begin())] = color;
+  }
+
+  output = result;
+  return true;
+}
+
+} // namespace xxx
@@ -0,0 +1,93 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <array>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "xxx.h"
+
+namespace xxx {
+
+/// Color names used in theme files (im_color_id order)
+inline constexpr auto im_color_names = std::to_array<std::string_view>({
+    "text",
+    "background",
+    "border",
+    "view_inactive_border",
+    "view_inactive_title",
+    "view_active_border",
+    "view_active_title",
+    "button_inactive_background",
+    "button_inactive_text",
+    "button_inactive_fx",
+    "button_active_background",
+    "button_active_text",
+    "button_active_fx",
+    "input_inactive_background",
+    "input_inactive_text",
+    "input_inactive_prompt",
+    "input_active_background",
+    "input_active_text",
+    "input_active_prompt",
+    "input_placeholder",
+});
+
+static_assert(im_color_names.size() == static_cast<std::size_t>(im_color_id::last));
+
+/// Theme file
+///
+/// Format is a line per color, "#" starts comment:
+///   <color name> = 0xRRGGBB | default
+///
+/// File is read into fixed buffer on every reload (no allocations, files above 4KB are rejected) and
+/// watched for changes with inotify (parent directory is watched, so editors replacing file on save
+/// are handled too). Colors not set by file keep built-in values.
+class im_theme_file {
+public:
+  // parsed colors, std::nullopt - color not set by file
+  using colors = std::array<std::optional<im_color>, static_cast<std::size_t>(im_color_id::last)>;
+
+private:
+  // max theme file size
+  static constexpr std::size_t max_file_size = 4096;
+
+  std::string path_;
+  std::string_view filename_;
+  int inotify_fd_ = -1;
+  // file content of last read
+  std::array<char, max_file_size> buffer_;
+
+public:
+  im_theme_file(im_theme_file const&) = delete;
+  im_theme_file& operator=(im_theme_file const&) = delete;
+
+  im_theme_file() = default;
+
+  ~im_theme_file() {
+    this->close();
+  }
+
+  /// Set theme file path and start watching it
+  /// @return false on watch setup failure
+  auto open(std::string_view path, bool watch) -> bool;
+
+  /// Stop watching
+  void close() noexcept;
+
+  /// Parse theme file
+  /// @return false on file read or parse error, or file is too large (output is left untouched)
+  [[nodiscard]] auto read(colors& output) noexcept -> bool;
+
+  /// Check theme file changed since last call (non-blocking)
+  [[nodiscard]] auto changed() noexcept -> bool;
+
+  /// Parse theme content
+  /// @return false on parse error
+  [[nodiscard]] static auto parse(std::string_view content, colors& output) noexcept -> bool;
+};
+
+} // namespace xxx
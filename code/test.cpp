@@ -70,101 +70,122 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
       }
       xxx::pop_color();
 
-      xxx::view_begin("view1");
-      xxx::label(string_value_1);
-      xxx::label(string_value_2);
-      xxx::layout_row_begin(3);
-      xxx::layout_row_push(0.2);
-      xxx::push_color(xxx::im_color_id::background, 0x111111_c);
-      xxx::label("row 1 column 1");
-      xxx::pop_color();
-      xxx::layout_row_push(0.4);
-      xxx::push_color(xxx::im_color_id::background, 0x222222_c);
-      xxx::label("row 1 column 2");
-      xxx::pop_color();
-      xxx::layout_row_push(0.99);
-      xxx::push_color(xxx::im_color_id::background, 0x333333_c);
-      xxx::label("row 1 column 3 line 1");
-      xxx::label("row 1 column 3 line 2");
-      xxx::label("row 1 column 3 line 3");
-      xxx::pop_color();
-      xxx::layout_row_end();
-      xxx::view_end();
-
-      xxx::view_begin("view2", xxx::im_key_id::ctrl_f);
-      xxx::layout_row_begin(3);
-      xxx::layout_row_push(0.4);
-      xxx::push_color(xxx::im_color_id::background, 0x444444_c);
-      xxx::label("row 2 column 1 line 1");
-      xxx::label("row 2 column 1 line 2");
-      xxx::pop_color();
-      xxx::layout_row_push(0.2);
-      xxx::push_color(xxx::im_color_id::background, 0x555555_c);
-      xxx::label("row 2 column 2");
-      xxx::pop_color();
-      xxx::layout_row_push(0.4);
-      xxx::push_color(xxx::im_color_id::background, 0x666666_c);
-      xxx::label("row 2 column 3 line 1");
-      xxx::pop_color();
-      xxx::layout_row_end();
-
-      xxx::layout_row_begin(2);
-      xxx::layout_row_push(0.5);
-      if (xxx::button("show label##1")) {
-        show_label_1 = !show_label_1;
-      }
-      xxx::layout_row_push(0.5);
-      if (show_label_1) {
-        xxx::label("this is first label");
-        xxx::spinner<struct L1>("label1 spinner");
-      }
-      xxx::layout_row_end();
-      xxx::layout_row_begin(2);
-      xxx::layout_row_push(0.5);
-      if (xxx::button("show label##2")) {
-        show_label_2 = !show_label_2;
+      if (xxx::view_begin("view1")) {
+        xxx::label(string_value_1);
+        xxx::label(string_value_2);
+        xxx::layout_row_begin({xxx::im_flex_fixed(16), xxx::im_flex_grow(1, 16), xxx::im_flex_grow(2, 22)});
+        xxx::layout_row_push();
+        xxx::push_color(xxx::im_color_id::background, 0x111111_c);
+        xxx::label("row 1 column 1");
+        xxx::pop_color();
+        xxx::layout_row_push();
+        xxx::push_color(xxx::im_color_id::background, 0x222222_c);
+        xxx::label("row 1 column 2");
+        xxx::pop_color();
+        xxx::layout_row_push();
+        xxx::push_color(xxx::im_color_id::background, 0x333333_c);
+        xxx::label("row 1 column 3 line 1");
+        xxx::label("row 1 column 3 line 2");
+        xxx::label("row 1 column 3 line 3");
+        xxx::pop_color();
+        xxx::layout_row_end();
+        xxx::view_end();
       }
-      xxx::layout_row_push(0.5);
-      if (show_label_2) {
-        xxx::label("this is second label");
-        xxx::spinner<struct L2>("label2 spinner");
+
+      if (xxx::view_begin("view2", xxx::im_key_id::ctrl_f)) {
+        xxx::layout_row_begin(3);
+        xxx::layout_row_push(0.4);
+        xxx::push_color(xxx::im_color_id::background, 0x444444_c);
+        xxx::label("row 2 column 1 line 1");
+        xxx::label("row 2 column 1 line 2");
+        xxx::pop_color();
+        xxx::layout_row_push(0.2);
+        xxx::push_color(xxx::im_color_id::background, 0x555555_c);
+        xxx::label("row 2 column 2");
+        xxx::pop_color();
+        xxx::layout_row_push(0.4);
+        xxx::push_color(xxx::im_color_id::background, 0x666666_c);
+        xxx::label("row 2 column 3 line 1");
+        xxx::pop_color();
+        xxx::layout_row_end();
+
+        xxx::layout_row_begin(2);
+        xxx::layout_row_push(0.5);
+        if (xxx::button("show label##1")) {
+          show_label_1 = !show_label_1;
+        }
+        xxx::layout_row_push(0.5);
+        if (show_label_1) {
+          xxx::label("this is first label");
+          xxx::spinner<struct L1>("label1 spinner");
+        }
+        xxx::layout_row_end();
+        xxx::layout_row_begin(2);
+        xxx::layout_row_push(0.5);
+        if (xxx::button("show label##2")) {
+          show_label_2 = !show_label_2;
+        }
+        xxx::layout_row_push(0.5);
+        if (show_label_2) {
+          xxx::label("this is second label");
+          xxx::spinner<struct L2>("label2 spinner");
+        }
+        xxx::layout_row_end();
+        xxx::view_end();
       }
-      xxx::layout_row_end();
-      xxx::view_end();
 
-      xxx::view_begin("view4", xxx::im_key_id::ctrl_t);
-      if (xxx::button("Button 1##1")) {}
-      if (xxx::button("Button 2##2")) {}
-      if (xxx::button("Button 3##3")) {}
-      xxx::view_end();
+      if (xxx::view_begin("view4", xxx::im_key_id::ctrl_t)) {
+        if (xxx::button("Button 1##1")) {}
+        if (xxx::button("Button 2##2")) {}
+        if (xxx::button("Button 3##3")) {}
+        xxx::view_end();
+      }
 
-      xxx::view_begin("view3", xxx::im_key_id::ctrl_g);
-      xxx::layout_row_begin(2);
-      xxx::layout_row_push(0.3);
-      xxx::push_color(xxx::im_color_id::background, 0x777777_c);
-      xxx::label("row 3 column 1 line 1");
-      xxx::label("row 3 column 1 line 2");
-      xxx::pop_color();
-      xxx::layout_row_push(0.7);
-      xxx::push_color(xxx::im_color_id::background, 0x888888_c);
-      xxx::label("row 3 column 2 line 1");
-      xxx::label("row 3 column 2 line 2");
-      xxx::label("row 3 column 2 line 3");
-      xxx::label("row 3 column 2 line 4");
-      xxx::pop_color();
-      xxx::layout_row_end();
-      xxx::layout_row_begin(2);
-      xxx::layout_row_push(0.4);
-      if (xxx::text_input("enter value##1", string_value_1)) {
-        string_value_1.clear();
+      if (xxx::view_begin("view3", xxx::im_key_id::ctrl_g)) {
+        xxx::layout_row_begin(2);
+        xxx::layout_row_push(0.3);
+        xxx::push_color(xxx::im_color_id::background, 0x777777_c);
+        xxx::label("row 3 column 1 line 1");
+        xxx::label("row 3 column 1 line 2");
+        xxx::pop_color();
+        xxx::layout_row_push(0.7);
+        xxx::push_color(xxx::im_color_id::background, 0x888888_c);
+        xxx::label("row 3 column 2 line 1");
+        xxx::label("row 3 column 2 line 2");
+        xxx::label("row 3 column 2 line 3");
+        xxx::label("row 3 column 2 line 4");
+        xxx::pop_color();
+        xxx::layout_row_end();
+        xxx::layout_row_begin(2);
+        xxx::layout_row_push(0.4);
+        if (xxx::text_input("enter value##1", string_value_1)) {
+          string_value_1.clear();
+        }
+        xxx::layout_row_push(0.6);
+        if (xxx::text_input("enter value##2", string_value_2)) {
+          string_value_2.clear();
+        }
+        if (xxx::text_input("##4", string_value_3)) {}
+        xxx::layout_row_end();
+        xxx::view_end();
       }
-      xxx::layout_row_push(0.6);
-      if (xxx::text_input("enter value##2", string_value_2)) {
-        string_value_2.clear();
+
+      if (xxx::view_begin("grid", xxx::im_view_flag_title)) {
+        // cells of a row have different content heights, backgrounds must span whole row
+        xxx::grid_begin({xxx::im_flex_grow(1, 12), xxx::im_flex_grow(1, 12), xxx::im_flex_grow(1, 12)}, 2);
+        for (int row = 0; row < 2; ++row) {
+          for (int column = 0; column < 3; ++column) {
+            xxx::push_color(xxx::im_color_id::background, (row + column) % 2 ? 0x435058_c : 0x848c8e_c);
+            xxx::grid_cell(column, row);
+            for (int line = 0; line <= (column + row) % 3; ++line) {
+              xxx::labelf("cell {}:{} line {}", row, column, line);
+            }
+            xxx::pop_color();
+          }
+        }
+        xxx::grid_end();
+        xxx::view_end();
       }
-      if (xxx::text_input("##4", string_value_3)) {}
-      xxx::layout_row_end();
-      xxx::view_end();
 
       xxx::push_color(xxx::im_color_id::background, 0xaa3333_c);
       xxx::label("end of layouts");
@@ -172,20 +193,22 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
 
       xxx::layout_row_begin(2);
       xxx::layout_row_push(0.4);
-      xxx::view_begin("view4", xxx::im_view_flag_title);
-      xxx::layout_row_begin(2);
-      xxx::layout_row_push(0.7);
-      xxx::panel_begin();
-      xxx::label("abcd");
-      xxx::label("123456");
-      xxx::panel_end();
-      xxx::layout_row_end();
-      xxx::view_end();
+      if (xxx::view_begin("view4", xxx::im_view_flag_title)) {
+        xxx::layout_row_begin(2);
+        xxx::layout_row_push(0.7);
+        xxx::panel_begin();
+        xxx::label("abcd");
+        xxx::label("123456");
+        xxx::panel_end();
+        xxx::layout_row_end();
+        xxx::view_end();
+      }
       xxx::layout_row_push(0.6);
       xxx::push_color(xxx::im_color_id::background, 0x667755_c);
-      xxx::view_begin("view5", xxx::im_view_flag_title);
-      xxx::label("final layout");
-      xxx::view_end();
+      if (xxx::view_begin("view5", xxx::im_view_flag_title)) {
+        xxx::label("final layout");
+        xxx::view_end();
+      }
       xxx::pop_color();
       xxx::layout_row_end();
 
@@ -53,34 +53,34 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
 
       xxx::layout_row_begin(2);
       xxx::layout_row_push(0.5);
-      xxx::view_begin("demo");
+      if (xxx::view_begin("demo")) {
+        xxx::button("action 1##1");
+        xxx::same_line();
+        xxx::button("action 2##2");
+        xxx::same_line();
+        xxx::button("action 3##3");
+        xxx::same_line();
+        xxx::button("action 5##5");
 
-      xxx::button("action 1##1");
-      xxx::same_line();
-      xxx::button("action 2##2");
-      xxx::same_line();
-      xxx::button("action 3##3");
-      xxx::same_line();
-      xxx::button("action 5##5");
+        xxx::button("action 4##4");
 
-      xxx::button("action 4##4");
+        xxx::label("label 1");
 
-      xxx::label("label 1");
+        xxx::label("label 2");
+        xxx::same_line();
+        xxx::label("label 3");
 
-      xxx::label("label 2");
-      xxx::same_line();
-      xxx::label("label 3");
+        xxx::label("----");
 
-      xxx::label("----");
+        xxx::text_input("First name", first_name);
+        xxx::same_line();
+        xxx::text_input("Second name", second_name);
+        xxx::text_input("Age", age);
 
-      xxx::text_input("First name", first_name);
-      xxx::same_line();
-      xxx::text_input("Second name", second_name);
-      xxx::text_input("Age", age);
+        xxx::label("----");
 
-      xxx::label("----");
-
-      xxx::view_end();
+        xxx::view_end();
+      }
       xxx::layout_row_end();
 
       xxx::render();
@@ -0,0 +1,102 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0
+
+// Heap allocations check on terminal: steady state frames (no input) must not allocate
+// (checks without terminal are in test_2.cpp)
+//
+// usage: xtest_1 [frames]
+
+#include <charconv>
+#include <chrono>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <xxx.h>
+
+#include "test_allocations.h"
+
+namespace {
+
+// frames to warm up caches before counting
+constexpr auto warmup_frames = 10;
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  auto frames = 100;
+  if (argc > 1) {
+    auto const arg = std::string_view(argv[1]);
+    auto const [ptr, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), frames);
+    if (ec != std::errc() || ptr != arg.data() + arg.size() || frames <= 0) {
+      std::print(stderr, "usage: {} [frames]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  auto failed_frames = 0;
+  auto max_allocations = std::size_t(0);
+  try {
+    std::string name = "name";
+    auto progress = 0.0f;
+
+    xxx::init();
+    xxx::bind_keys("g g", "top");
+
+    for (int frame = 0; frame < frames; ++frame) {
+      auto const allocations = g_allocations.load();
+
+      xxx::process_input_events();
+      if (xxx::is_key_pressed(xxx::im_key_id::ctrl_c) || xxx::is_key_pressed(xxx::im_key_id::ctrl_q)) {
+        break;
+      }
+
+      xxx::new_frame();
+
+      if (xxx::view_begin("allocations")) {
+        xxx::spinner("spinner");
+        xxx::labelf("frame {} of {}", frame, frames);
+        xxx::text_input("Name", name);
+        if (xxx::is_action_triggered("top")) {
+          progress = 0.0f;
+        }
+        xxx::progress(progress);
+        progress = progress < 100.0f ? progress + 1.0f : 0.0f;
+
+        xxx::grid_begin({xxx::im_flex_grow(1, 8), xxx::im_flex_grow(1, 8)}, 2);
+        for (int row = 0; row < 2; ++row) {
+          for (int column = 0; column < 2; ++column) {
+            xxx::grid_cell(column, row);
+            xxx::labelf("cell {}:{}", row, column);
+          }
+        }
+        xxx::grid_end();
+        xxx::view_end();
+      }
+
+      xxx::render();
+
+      auto const frame_allocations = g_allocations.load() - allocations;
+      if (frame >= warmup_frames && xxx::get_frame_stats().input_events == 0 && frame_allocations > 0) {
+        failed_frames++;
+        max_allocations = std::max(max_allocations, frame_allocations);
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(1000) / 60);
+    }
+
+    xxx::shutdown();
+  } catch (std::exception const& e) {
+    std::print(stderr, "ERROR: {}\n", e.what());
+    return EXIT_FAILURE;
+  }
+
+  if (failed_frames > 0) {
+    std::print(stderr, "FAIL: {} steady frames allocated (up to {} allocations per frame)\n", failed_frames,
+        max_allocations);
+    return EXIT_FAILURE;
+  }
+  std::print("OK\n");
+  return EXIT_SUCCESS;
+}
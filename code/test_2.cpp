@@ -0,0 +1,132 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0
+
+// Heap allocations check without terminal: per frame containers must reuse their capacity
+// or live in frame arena, caches must not allocate on steady frames.
+//
+// usage: xtest_2
+
+#include <print>
+#include <string_view>
+
+#include <xxx.h>
+
+#include <im_allocator.h>
+#include <im_flex_layout.h>
+#include <im_hit_index.h>
+#include <im_input.h>
+#include <im_keymap.h>
+#include <im_memory_resource.h>
+#include <im_text_cache.h>
+#include <im_text_layout.h>
+
+#include "test_allocations.h"
+
+namespace {
+
+// frames run after warm up frame
+constexpr auto frames = 3;
+
+// run frame once to warm up, then count heap allocations of next frames
+// @return number of heap allocations after warm up
+template <typename Frame>
+auto count_allocations(Frame&& frame) -> std::size_t {
+  frame();
+  auto const allocations = g_allocations.load();
+  for (int i = 0; i < frames; ++i) {
+    frame();
+  }
+  return g_allocations.load() - allocations;
+}
+
+// input events, paste text, key bindings and hit index filled like a frame with typing and paste does
+auto check_input() -> std::size_t {
+  auto input = xxx::im_input();
+  auto hit_index = xxx::im_hit_index();
+  auto keymap = xxx::im_keymap();
+
+  xxx::im_keymap::key_code const sequence[] = {'g', 'g'};
+  keymap.bind(xxx::im_id(), sequence, xxx::im_id(1));
+
+  std::uint32_t const paste[] = {'p', 'a', 's', 't', 'e'};
+  return count_allocations([&] {
+    input.reset();
+    for (int i = 0; i < 100; ++i) {
+      input.add_character('g');
+      input.add_key_event(xxx::im_key_id::enter);
+    }
+    input.add_paste(paste);
+    input.add_paste(paste);
+    keymap.process(input, xxx::im_id(), xxx::im_clock::now());
+
+    hit_index.reset(xxx::im_rect(0, 0, 199, 59));
+    for (int i = 0; i < 100; ++i) {
+      hit_index.add(xxx::im_id(i + 1), xxx::im_id(), xxx::im_rect(i, i % 60, i + 20, i % 60));
+    }
+  });
+}
+
+// frame containers allocated from frame arena
+auto check_frame_arena() -> std::size_t {
+  auto allocator = xxx::im_allocator();
+  allocator.reserve(64 * 1024);
+  auto resource = xxx::im_memory_resource(allocator);
+
+  auto const allocations = count_allocations([&] {
+    allocator.reset();
+    resource.reset_stats();
+    auto commands = xxx::im_vector<int>(&resource);
+    for (int i = 0; i < 1000; ++i) {
+      commands.push_back(i);
+    }
+    auto title = xxx::im_string(&resource);
+    title.append(100, 'x');
+  });
+  return allocations + resource.upstream_allocations();
+}
+
+// text metrics, text layout and flex layout caches on repeated content
+auto check_caches() -> std::size_t {
+  auto text_cache = xxx::im_text_cache();
+  auto text_layout_cache = xxx::im_text_layout_cache();
+  auto flex_layout_cache = xxx::im_flex_layout_cache();
+
+  constexpr auto paragraph = std::string_view("wrapped paragraph of text which doesn't fit into single line");
+  xxx::im_flex const columns[] = {xxx::im_flex_fixed(10), xxx::im_flex_grow(1, 8), xxx::im_flex_grow(2, 8)};
+  return count_allocations([&] {
+    text_cache.new_frame();
+    text_layout_cache.new_frame();
+    flex_layout_cache.new_frame();
+
+    for (auto const text : {std::string_view("label"), std::string_view("button"), paragraph}) {
+      [[maybe_unused]] auto const metrics = text_cache.get(text);
+    }
+    if (auto const metrics = text_cache.get(paragraph); metrics) {
+      [[maybe_unused]] auto const lines =
+          text_layout_cache.get(metrics->hash, metrics->text, metrics->width, 20, xxx::im_text_overflow::wrap);
+    }
+    [[maybe_unused]] auto const widths = flex_layout_cache.get(columns, 80);
+  });
+}
+
+} // namespace
+
+int main() {
+  auto failed = false;
+  auto const check = [&](std::string_view name, std::size_t allocations) {
+    if (allocations > 0) {
+      std::print(stderr, "FAIL: {}: {} heap allocations on steady frames\n", name, allocations);
+      failed = true;
+    }
+  };
+
+  check("input", check_input());
+  check("frame arena", check_frame_arena());
+  check("caches", check_caches());
+
+  if (failed) {
+    return EXIT_FAILURE;
+  }
+  std::print("OK\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,47 @@
+// Copyright (c) Sergey Kovalevich <inndie@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0
+
+// Heap allocations counter for tests: global operator new is replaced,
+// header is expected to be included by single translation unit of test executable.
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// heap allocations since start
+inline std::atomic<std::size_t> g_allocations = 0;
+
+void* operator new(std::size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto const result = std::malloc(size == 0 ? 1 : size); result) {
+    return result;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  auto const align = static_cast<std::size_t>(alignment);
+  if (auto const result = std::aligned_alloc(align, (size + align - 1) / align * align); result) {
+    return result;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
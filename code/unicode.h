@@ -10,6 +10,35 @@
 #include <vector>
 
 namespace xxx {
+namespace detail {
+
+// lookup width in two-level table
+[[nodiscard]] auto char_width_lookup(std::uint32_t ch) noexcept -> int;
+
+} // namespace detail
+
+// terminal display width of code point (wcwidth equivalent)
+// 0 - combining and zero width characters, 1 - narrow, 2 - wide (CJK, emoji), -1 - control character
+[[nodiscard]] inline auto char_width(std::uint32_t ch) noexcept -> int {
+  if (ch < 0x7f) [[likely]] {
+    return ch >= 0x20 ? 1 : -1;
+  }
+  return detail::char_width_lookup(ch);
+}
+
+// extended grapheme cluster (user-perceived character)
+struct grapheme_cluster {
+  // number of code points
+  std::size_t length = 0;
+  // display width (control character is shown as blank cell, lone combining character takes no cells)
+  int width = 0;
+};
+
+// get grapheme cluster at the beginning of text
+[[nodiscard]] auto next_grapheme_cluster(std::span<std::uint32_t const> text) noexcept -> grapheme_cluster;
+
+// terminal display width of text
+[[nodiscard]] auto text_width(std::span<std::uint32_t const> text) noexcept -> int;
 
 // convert utf8 string to unicode
 // WARNING: result valid until next call
@@ -5,13 +5,19 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cerrno>
 #include <format>
 #include <functional>
 #include <iterator>
+#include <mutex>
 #include <ranges>
 #include <string_view>
+#include <thread>
+
+#include <poll.h>
 
 #include "im_context.h"
+#include "im_keys.h"
 
 #if 0
 #include <print>
@@ -35,150 +41,344 @@ namespace xxx {
 
 namespace {
 
-[[nodiscard]] constexpr auto get_shorcut_label(im_key_id shortcut) noexcept -> std::string_view {
-  using namespace std::string_view_literals;
-
-  switch (shortcut) {
-  case im_key_id::ctrl_a:
-    return "c-a"sv;
-  case im_key_id::ctrl_b:
-    return "c-b"sv;
-  case im_key_id::ctrl_c:
-    return "c-c"sv;
-  case im_key_id::ctrl_d:
-    return "c-d"sv;
-  case im_key_id::ctrl_e:
-    return "c-e"sv;
-  case im_key_id::ctrl_f:
-    return "c-f"sv;
-  case im_key_id::ctrl_g:
-    return "c-g"sv;
-  case im_key_id::ctrl_j:
-    return "c-j"sv;
-  case im_key_id::ctrl_k:
-    return "c-k"sv;
-  case im_key_id::ctrl_n:
-    return "c-n"sv;
-  case im_key_id::ctrl_o:
-    return "c-o"sv;
-  case im_key_id::ctrl_p:
-    return "c-p"sv;
-  case im_key_id::ctrl_q:
-    return "c-q"sv;
-  case im_key_id::ctrl_r:
-    return "c-r"sv;
-  case im_key_id::ctrl_s:
-    return "c-s"sv;
-  case im_key_id::ctrl_t:
-    return "c-t"sv;
-  case im_key_id::ctrl_u:
-    return "c-u"sv;
-  case im_key_id::ctrl_v:
-    return "c-v"sv;
-  case im_key_id::ctrl_w:
-    return "c-w"sv;
-  case im_key_id::ctrl_x:
-    return "c-x"sv;
-  case im_key_id::ctrl_y:
-    return "c-y"sv;
-  case im_key_id::ctrl_z:
-    return "c-z"sv;
-  default:
-    return "";
-  }
-}
-
-void handle_terminal_key_event(::tb_event const& event) {
-  switch (event.key) {
-  case TB_KEY_BACKSPACE:
-    return g_ctx->input.add_key_event(im_key_id::backspace);
-  case TB_KEY_BACKSPACE2:
-    return g_ctx->input.add_key_event(im_key_id::backspace2);
-  case TB_KEY_DELETE:
-    return g_ctx->input.add_key_event(im_key_id::del);
-  case TB_KEY_TAB:
-    return g_ctx->input.add_key_event(im_key_id::tab);
-  case TB_KEY_ENTER:
-    return g_ctx->input.add_key_event(im_key_id::enter);
-  case TB_KEY_ESC:
-    return g_ctx->input.add_key_event(im_key_id::esc);
-  case TB_KEY_SPACE:
-    return g_ctx->input.add_key_event(im_key_id::space);
-  case TB_KEY_HOME:
-    return g_ctx->input.add_key_event(im_key_id::home);
-  case TB_KEY_END:
-    return g_ctx->input.add_key_event(im_key_id::end);
-  case TB_KEY_ARROW_UP:
-    return g_ctx->input.add_key_event(im_key_id::arrow_up);
-  case TB_KEY_ARROW_DOWN:
-    return g_ctx->input.add_key_event(im_key_id::arrow_down);
-  case TB_KEY_ARROW_LEFT:
-    return g_ctx->input.add_key_event(im_key_id::arrow_left);
-  case TB_KEY_ARROW_RIGHT:
-    return g_ctx->input.add_key_event(im_key_id::arrow_right);
-  case TB_KEY_CTRL_A:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_a);
-  case TB_KEY_CTRL_B:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_b);
-  case TB_KEY_CTRL_C:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_c);
-  case TB_KEY_CTRL_D:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_d);
-  case TB_KEY_CTRL_E:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_e);
-  case TB_KEY_CTRL_F:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_f);
-  case TB_KEY_CTRL_G:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_g);
-  case TB_KEY_CTRL_J:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_j);
-  case TB_KEY_CTRL_K:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_k);
-  case TB_KEY_CTRL_N:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_n);
-  case TB_KEY_CTRL_O:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_o);
-  case TB_KEY_CTRL_P:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_p);
-  case TB_KEY_CTRL_Q:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_q);
-  case TB_KEY_CTRL_R:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_r);
-  case TB_KEY_CTRL_S:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_s);
-  case TB_KEY_CTRL_T:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_t);
-  case TB_KEY_CTRL_U:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_u);
-  case TB_KEY_CTRL_V:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_v);
-  case TB_KEY_CTRL_W:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_w);
-  case TB_KEY_CTRL_X:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_x);
-  case TB_KEY_CTRL_Y:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_y);
-  case TB_KEY_CTRL_Z:
-    return g_ctx->input.add_key_event(im_key_id::ctrl_z);
+// decode termbox2 event into input events
+// called from input thread so it must not touch global context
+template <typename Emit>
+void decode_terminal_event(::tb_event const& event, im_clock::time_point time, Emit&& emit) {
+  switch (event.type) {
+  case TB_EVENT_KEY: {
+    if (event.ch > 0) {
+      emit(im_input_event{.type = im_input_event_type::character, .time = time, .ch = event.ch});
+      if (event.ch == ' ') {
+        emit(im_input_event{.type = im_input_event_type::key, .time = time, .key = im_key_id::space});
+      }
+    } else if (event.key > 0) {
+      if (auto const key = translate_key(event.key, event.mod); key != im_key_id()) {
+        emit(im_input_event{.type = im_input_event_type::key, .time = time, .key = key});
+      }
+    }
+  } break;
+  case TB_EVENT_MOUSE: {
+    auto const pos = im_vec2(event.x, event.y);
+    emit(im_input_event{.type = im_input_event_type::mouse_move, .time = time, .pos = pos});
+
+    auto const emit_button = [&](im_mouse_button_id id) {
+      emit(im_input_event{.type = im_input_event_type::mouse_button, .time = time, .pos = pos, .button = id});
+    };
+    auto const emit_wheel = [&](int wheel) {
+      emit(im_input_event{.type = im_input_event_type::mouse_wheel, .time = time, .pos = pos, .wheel = wheel});
+    };
+
+    if (event.mod & TB_MOD_MOTION) {
+      // move with button held
+      return;
+    }
+
+    switch (event.key) {
+    case TB_KEY_MOUSE_LEFT:
+      return emit_button(im_mouse_button_id::left);
+    case TB_KEY_MOUSE_RIGHT:
+      return emit_button(im_mouse_button_id::right);
+    case TB_KEY_MOUSE_MIDDLE:
+      return emit_button(im_mouse_button_id::middle);
+    case TB_KEY_MOUSE_WHEEL_UP:
+      return emit_wheel(-1);
+    case TB_KEY_MOUSE_WHEEL_DOWN:
+      return emit_wheel(+1);
+    case TB_KEY_MOUSE_RELEASE:
+      return emit(im_input_event{.type = im_input_event_type::mouse_release, .time = time, .pos = pos});
+    default:
+      break;
+    }
+  } break;
+  case TB_EVENT_RESIZE: {
+    emit(im_input_event{.type = im_input_event_type::resize, .time = time, .pos = im_vec2(event.w, event.h)});
+  } break;
   default:
     break;
   }
 }
 
-void handle_terminal_mouse_event(::tb_event const& event) {
-  g_ctx->input.add_mouse_pos_event(im_vec2(event.x, event.y));
+// bracketed paste markers
+// https://invisible-island.net/xterm/ctlseqs/ctlseqs.html#h2-Bracketed-Paste-Mode
+constexpr auto paste_begin_marker = std::string_view("\x1b[200~");
+constexpr auto paste_end_marker = std::string_view("\x1b[201~");
+
+// pass partially matched paste begin marker as regular input
+void flush_paste_marker(im_clock::time_point time) {
+  auto& paste = g_ctx->paste;
+
+  for (auto const ch : paste_begin_marker.substr(0, std::exchange(paste.marker_pos, 0))) {
+    if (ch == '\x1b') {
+      g_ctx->input.add_event(im_input_event{.type = im_input_event_type::key, .time = time, .key = im_key_id::esc});
+    } else {
+      g_ctx->input.add_event(
+          im_input_event{.type = im_input_event_type::character, .time = time, .ch = std::uint32_t(ch)});
+    }
+  }
+}
+
+// detect bracketed paste and collect pasted text
+// termbox2 doesn't know paste markers so they arrive as "esc" key followed by characters
+// @return true on event consumed
+auto handle_paste_event(im_input_event const& event) -> bool {
+  auto& paste = g_ctx->paste;
 
-  if (event.key > 0) {
+  auto ch = std::uint32_t(0);
+  switch (event.type) {
+  case im_input_event_type::character:
+    ch = event.ch;
+    break;
+  case im_input_event_type::key:
     switch (event.key) {
-    case TB_KEY_MOUSE_LEFT:
-      return g_ctx->input.add_mouse_button_event(im_mouse_button_id::left, im_vec2(event.x, event.y));
-    case TB_KEY_MOUSE_RIGHT:
-      return g_ctx->input.add_mouse_button_event(im_mouse_button_id::right, im_vec2(event.x, event.y));
-    case TB_KEY_MOUSE_MIDDLE:
-      return g_ctx->input.add_mouse_button_event(im_mouse_button_id::middle, im_vec2(event.x, event.y));
+    case im_key_id::esc:
+      ch = '\x1b';
+      break;
+    case im_key_id::enter:
+    case im_key_id::ctrl_j:
+      ch = '\n';
+      break;
+    case im_key_id::tab:
+      ch = '\t';
+      break;
     default:
       break;
     }
+    break;
+  default:
+    break;
+  }
+
+  if (ch == 0) {
+    if (!paste.active) {
+      flush_paste_marker(event.time);
+    }
+    // drop other events inside paste
+    return paste.active;
+  }
+
+  if (!paste.active) {
+    if (ch == std::uint32_t(paste_begin_marker[paste.marker_pos])) {
+      if (++paste.marker_pos == paste_begin_marker.size()) {
+        paste.active = true;
+        paste.marker_pos = 0;
+        paste.time = event.time;
+        paste.text.clear();
+      }
+      return true;
+    }
+    if (paste.marker_pos == 0) {
+      return false;
+    }
+    flush_paste_marker(event.time);
+    // current event could start marker again
+    return handle_paste_event(event);
+  }
+
+  if (ch == std::uint32_t(paste_end_marker[paste.marker_pos])) {
+    if (++paste.marker_pos == paste_end_marker.size()) {
+      g_ctx->input.add_paste(paste.text, paste.time);
+      paste.active = false;
+      paste.marker_pos = 0;
+      paste.text.clear();
+    }
+    return true;
+  }
+
+  // partially matched end marker is a part of pasted text
+  for (auto const marker_ch : paste_end_marker.substr(0, std::exchange(paste.marker_pos, 0))) {
+    paste.text.push_back(marker_ch);
+  }
+  if (ch == '\x1b') {
+    paste.marker_pos = 1;
+  } else {
+    paste.text.push_back(ch);
+  }
+
+  return true;
+}
+
+// pass event to input state through paste detection
+void add_input_event(im_input_event const& event) {
+  if (event.type == im_input_event_type::none) {
+    // lone "esc" is not a paste begin marker
+    if (!g_ctx->paste.active) {
+      flush_paste_marker(event.time);
+    }
+    return;
+  }
+  if (handle_paste_event(event)) {
+    return;
+  }
+  g_ctx->input.add_event(event);
+}
+
+// pass partially matched terminal reply as regular input
+void flush_terminal_reply(im_clock::time_point time) {
+  auto& reply = g_ctx->terminal_reply;
+
+  for (auto const ch : std::span(reply.matched).first(std::exchange(reply.matched_size, 0))) {
+    if (ch == '\x1b') {
+      add_input_event(im_input_event{.type = im_input_event_type::key, .time = time, .key = im_key_id::esc});
+    } else {
+      add_input_event(im_input_event{.type = im_input_event_type::character, .time = time, .ch = ch});
+    }
+  }
+}
+
+// drop late replies to init queries ("CSI ? <params> $ y" and "CSI ? <params> c")
+// termbox2 doesn't know them so they arrive as "esc" key followed by characters
+// @return true on event consumed
+auto handle_terminal_reply_event(im_input_event const& event) -> bool {
+  auto& reply = g_ctx->terminal_reply;
+  if (!reply.pending) [[likely]] {
+    return false;
+  }
+  if (event.time > reply.deadline) {
+    reply.pending = false;
+    flush_terminal_reply(event.time);
+    return false;
+  }
+
+  auto ch = std::uint32_t(0);
+  if (event.type == im_input_event_type::key && event.key == im_key_id::esc) {
+    ch = '\x1b';
+  } else if (event.type == im_input_event_type::character) {
+    ch = event.ch;
+  }
+
+  auto const matches = [&] {
+    switch (reply.matched_size) {
+    case 0:
+      return ch == '\x1b';
+    case 1:
+      return ch == '[';
+    case 2:
+      return ch == '?';
+    default:
+      return (ch >= '0' && ch <= '9') || ch == ';' || ch == '$' || ch == 'y' || ch == 'c';
+    }
+  }();
+  if (!matches || reply.matched_size == reply.matched.size()) {
+    flush_terminal_reply(event.time);
+    return false;
+  }
+
+  reply.matched[reply.matched_size++] = ch;
+  if (ch == 'y' || ch == 'c') {
+    // DA1 reply is the last one
+    reply.matched_size = 0;
+    reply.pending = ch != 'c';
+  }
+  return true;
+}
+
+// pass decoded event to input state
+void dispatch_input_event(im_input_event const& event) {
+  if (event.type == im_input_event_type::none) {
+    // reply is read at once, partial match is regular input
+    flush_terminal_reply(event.time);
+  } else if (handle_terminal_reply_event(event)) {
+    return;
+  }
+  add_input_event(event);
+}
+
+// pass keys typed during init queries as regular input
+// escape sequences (i.e. arrows) can't be told apart from partial ones here, they are dropped
+void dispatch_terminal_reply_input() {
+  auto& input = g_ctx->terminal_reply.input;
+  auto const time = im_clock::now();
+  for (std::size_t pos = 0; pos < input.size();) {
+    auto const byte = static_cast<unsigned char>(input[pos]);
+    if (byte == 0x1b && pos + 1 < input.size() && (input[pos + 1] == '[' || input[pos + 1] == 'O')) {
+      // skip CSI or SS3 sequence up to final byte
+      pos += 2;
+      while (pos < input.size() && !(input[pos] >= 0x40 && input[pos] <= 0x7e)) {
+        pos++;
+      }
+      pos++;
+      continue;
+    }
+    auto event = ::tb_event();
+    event.type = TB_EVENT_KEY;
+    if (byte < 0x20 || byte == 0x7f) {
+      // control key codes of termbox2 are byte values
+      event.key = byte;
+      pos++;
+    } else {
+      auto const length = std::size_t(::tb_utf8_char_length(input[pos]));
+      if (pos + length > input.size()) {
+        break;
+      }
+      ::tb_utf8_char_to_unicode(&event.ch, input.data() + pos);
+      pos += length;
+    }
+    decode_terminal_event(event, time, dispatch_input_event);
+  }
+  input.clear();
+}
+
+// input thread body
+// waits for terminal input, decodes events and passes them to the frame through queue
+void input_thread_main(std::stop_token stop_token, im_context::input_thread_state& state) {
+  // poll timeout to check stop request
+  static constexpr auto poll_timeout_ms = 50;
+
+  int fds[2] = {-1, -1};
+  ::tb_get_fds(&fds[0], &fds[1]);
+
+  ::pollfd pfds[2] = {};
+  auto nfds = ::nfds_t(0);
+  for (auto const fd : fds) {
+    if (fd >= 0) {
+      pfds[nfds++] = ::pollfd{.fd = fd, .events = POLLIN, .revents = 0};
+    }
+  }
+
+  auto const push = [&](im_input_event const& event) {
+    while (!state.queue.try_push(event)) {
+      // frame is behind, wait for queue drain
+      if (stop_token.stop_requested()) {
+        return;
+      }
+      std::this_thread::yield();
+    }
+  };
+
+  while (!stop_token.stop_requested()) {
+    if (auto const rc = ::poll(pfds, nfds, poll_timeout_ms); rc <= 0) {
+      if (rc < 0 && errno != EINTR) {
+        state.error.store(TB_ERR_POLL, std::memory_order_release);
+        return;
+      }
+      continue;
+    }
+
+    ::tb_event event;
+    auto count = std::size_t(0);
+    while (true) {
+      int rc, last_errno;
+      {
+        // termbox2 may resize cell buffers while reading input
+        auto const lock = std::lock_guard(state.terminal_mutex);
+        rc = ::tb_peek_event(&event, 0);
+        last_errno = ::tb_last_errno();
+      }
+      if (rc == TB_OK) {
+        decode_terminal_event(event, im_clock::now(), push);
+        count++;
+      } else if (rc == TB_ERR_NO_EVENT) {
+        break;
+      } else if (rc != TB_ERR_POLL || last_errno != EINTR) {
+        state.error.store(rc, std::memory_order_release);
+        return;
+      }
+    }
+
+    if (count > 0) {
+      push(im_input_event{.type = im_input_event_type::none, .time = im_clock::now()});
+    }
   }
 }
 
@@ -230,6 +430,26 @@ auto to_unicode(std::string_view input, OutputIt first) -> OutputIt {
   return std::span(buffer, pos);
 }
 
+// format text into frame arena (cut if arena is exhausted)
+template <typename... Ts>
+[[nodiscard]] auto format_to_frame(std::format_string<Ts...> fmt, Ts&&... args) -> std::string_view {
+  auto const buffer = detail::format_buffer();
+  auto const result = std::format_to_n(buffer.data(), std::ptrdiff_t(buffer.size()), fmt, std::forward<Ts>(args)...);
+  auto const size = std::min(std::size_t(result.size), buffer.size());
+  [[maybe_unused]] auto const data = g_ctx->allocator.allocate<char>(size);
+  return std::string_view(buffer.data(), size);
+}
+
+// decoded and measured text (cached across frames)
+[[nodiscard]] auto to_text_metrics(std::string_view input) -> im_text_metrics {
+  if (auto const metrics = g_ctx->text_cache.get(input); metrics) [[likely]] {
+    return *metrics;
+  }
+  // cache arena is exhausted until next frame
+  auto const text = to_unicode(input);
+  return im_text_metrics{.text = text, .width = text_width(text), .hash = im_text_cache::key(input)};
+}
+
 [[nodiscard]] constexpr auto unicode_codepoint_length(std::uint32_t c) noexcept -> std::size_t {
   if (c < 0x80) {
     return 1;
@@ -278,17 +498,95 @@ auto to_utf8(std::span<std::uint32_t const> input, OutputIt first) -> OutputIt {
   return first;
 }
 
-[[nodiscard]] auto get_style_bg(im_color_id bg_id) noexcept -> im_style {
-  return im_style(im_color(), g_ctx->theme.get_color(bg_id));
+[[nodiscard]] auto get_style(im_style_id id) noexcept -> im_style const& {
+  return g_ctx->theme.get_style(id);
+}
+
+// set colors loaded from theme file as default ones, colors missing in file get built-in values
+void apply_theme(im_theme_file::colors const& colors) noexcept {
+  g_ctx->theme.reset_default_colors();
+  for (std::size_t i = 0; i < colors.size(); ++i) {
+    if (colors[i]) {
+      g_ctx->theme.set_default_color(static_cast<im_color_id>(i), *colors[i]);
+    }
+  }
+}
+
+// get scroll lines requested for view by mouse wheel over view rect or arrow keys
+[[nodiscard]] auto view_scroll_input(im_rect const& rect, bool active) noexcept -> int {
+  auto result = 0;
+  for (auto const& event : g_ctx->input.get_input_events()) {
+    if (event.type == im_input_event_type::mouse_wheel && rect.contains(event.pos)) {
+      result += event.wheel;
+    }
+  }
+
+  // arrow keys belong to active multi-line editor if any
+  if (active && !g_ctx->text_editor.contains(g_ctx->widget.active_id)) {
+    if (is_key_pressed(im_key_id::arrow_up)) {
+      result--;
+    }
+    if (is_key_pressed(im_key_id::arrow_down)) {
+      result++;
+    }
+  }
+
+  return result;
+}
+
+// check left mouse button pressed inside rect (screen coordinates) during current frame
+[[nodiscard]] auto is_mouse_clicked(im_rect const& rect) noexcept -> bool {
+  return std::ranges::any_of(g_ctx->input.get_input_events(), [&](im_input_event const& event) {
+    return event.type == im_input_event_type::mouse_button && event.button == im_mouse_button_id::left &&
+           rect.contains(event.pos);
+  });
+}
+
+// reserve lines for view without content and finish view
+void view_skip(int height) {
+  auto& view = g_ctx->view;
+
+  auto const& parent_layout = g_ctx->layout.layout_state_stack.back();
+  g_ctx->layout.cursor = im_vec2(parent_layout.rect.min.x, g_ctx->layout.cursor.y + height);
+
+  view.current_title = "N/A";
+  view.current_id = im_id();
+  view.current_flags = 0;
+  view.active = false;
+  view.skipped = true;
 }
 
-[[nodiscard]] auto get_style(im_color_id fg_id, im_color_id bg_id) noexcept -> im_style {
-  return g_ctx->theme.get_style(fg_id, bg_id);
+// resolve mouse events against widgets of previous frame
+void resolve_mouse_events() {
+  auto& mouse = g_ctx->mouse;
+
+  mouse.clicked_id = im_id();
+  for (auto const& event : g_ctx->input.get_input_events()) {
+    if (event.type == im_input_event_type::mouse_button) {
+      if (event.button != im_mouse_button_id::left) {
+        continue;
+      }
+      auto const hit = g_ctx->hit_index.find(event.pos);
+      mouse.captured_id = hit ? hit->id : im_id();
+      mouse.clicked_id = mouse.captured_id;
+      mouse.drag_origin = event.pos;
+      if (hit && hit->view_id != im_id()) {
+        // focus clicked widget and its view
+        g_ctx->view.active_id = hit->view_id;
+        g_ctx->widget.active_id = hit->id;
+      }
+    } else if (event.type == im_input_event_type::mouse_release) {
+      mouse.captured_id = im_id();
+    }
+  }
+
+  auto const hit = g_ctx->hit_index.find(g_ctx->input.mouse_pos());
+  mouse.hot_id = hit ? hit->id : im_id();
 }
 
 } // namespace
 
-void init() {
+void init(int flags) {
   if (g_ctx) {
     delete g_ctx;
   }
@@ -301,14 +599,33 @@ void init() {
   }
 
   ::tb_set_input_mode(TB_INPUT_ESC | TB_INPUT_MOUSE);
-  ::tb_set_output_mode(TB_OUTPUT_TRUECOLOR);
-  ::tb_sendf("\x1b[?%d;%dh", 1003, 1006);
+
+  // frames are written by renderer directly to terminal,
+  // colors are kept in RGB and converted for terminals without truecolor support
+  int fds[2] = {-1, -1};
+  ::tb_get_fds(&fds[0], &fds[1]);
+  g_ctx->renderer.set_output_fd(fds[0]);
+  g_ctx->renderer.set_output_mode(detect_output_mode());
+  // terminal replies are read before input processing started
+  auto& terminal_reply = g_ctx->terminal_reply;
+  auto const synchronized = query_synchronized_output(fds[0], std::chrono::milliseconds(200), terminal_reply.input);
+  g_ctx->renderer.set_output_synchronized(synchronized.value_or(false));
+  terminal_reply.pending = !synchronized;
+  terminal_reply.deadline = im_clock::now() + std::chrono::seconds(2);
+  ::tb_sendf("\x1b[?%d;%d;%dh", 1003, 1006, 2004);
+
+  if (flags & im_init_flag_input_thread) {
+    g_ctx->input_thread.thread = std::jthread(input_thread_main, std::ref(g_ctx->input_thread));
+  }
 
   g_ctx->last_frame_time = im_clock::now();
 }
 
 void shutdown() {
-  ::tb_sendf("\x1b[?%d;%dl", 1003, 1006);
+  // input thread uses termbox2 so stop it first
+  g_ctx->input_thread.thread = std::jthread();
+
+  ::tb_sendf("\x1b[?%d;%d;%dl", 1003, 1006, 2004);
   ::tb_shutdown();
 
   delete g_ctx;
@@ -318,43 +635,47 @@ void shutdown() {
 void process_input_events() {
   g_ctx->input.reset();
 
-  ::tb_event event;
-
-  auto do_peek_events = true;
-  while (do_peek_events) {
-    auto const rc = ::tb_peek_event(&event, 0);
-    if (rc == TB_OK) {
-      switch (event.type) {
-      case TB_EVENT_KEY: {
-        if (event.ch > 0) {
-          g_ctx->input.add_character(event.ch);
-          if (event.ch == ' ') {
-            g_ctx->input.add_key_event(im_key_id::space);
-          }
-        } else if (event.key > 0) {
-          handle_terminal_key_event(event);
+  if (!g_ctx->terminal_reply.input.empty()) [[unlikely]] {
+    dispatch_terminal_reply_input();
+  }
+
+  auto& input_thread = g_ctx->input_thread;
+  if (input_thread.thread.joinable()) {
+    // drain events decoded by input thread
+    im_input_event event;
+    while (input_thread.queue.try_pop(event)) {
+      dispatch_input_event(event);
+    }
+    if (auto const rc = input_thread.error.load(std::memory_order_acquire); rc != TB_OK) {
+      throw std::runtime_error(::tb_strerror(rc));
+    }
+  } else {
+    ::tb_event event;
+
+    auto do_peek_events = true;
+    while (do_peek_events) {
+      auto const rc = ::tb_peek_event(&event, 0);
+      if (rc == TB_OK) {
+        decode_terminal_event(event, im_clock::now(), dispatch_input_event);
+      } else if (rc == TB_ERR_NO_EVENT) {
+        do_peek_events = false;
+        dispatch_input_event(im_input_event{.type = im_input_event_type::none, .time = im_clock::now()});
+      } else if (rc == TB_ERR_POLL) {
+        // handle poll error
+        if (::tb_last_errno() != EINTR) {
+          throw std::runtime_error(::tb_strerror(rc));
         }
-      } break;
-      case TB_EVENT_MOUSE: {
-        handle_terminal_mouse_event(event);
-      } break;
-      case TB_EVENT_RESIZE: {
-      } break;
-      default:
-        break;
-      }
-    } else if (rc == TB_ERR_NO_EVENT) {
-      do_peek_events = false;
-    } else if (rc == TB_ERR_POLL) {
-      // handle poll error
-      if (::tb_last_errno() != EINTR) {
-        throw std::runtime_error(::tb_strerror(rc));
       }
     }
   }
 
   auto& view = g_ctx->view;
   auto& widget = g_ctx->widget;
+
+  // key bindings take keys before widgets
+  auto const active_view_id = view.force_next_id != im_id() ? view.force_next_id : view.active_id;
+  g_ctx->keymap.process(g_ctx->input, active_view_id, im_clock::now());
+
   if (is_key_pressed(im_key_id::tab)) {
     if (widget.next_id != im_id()) {
       widget.active_id = widget.next_id;
@@ -370,6 +691,8 @@ void process_input_events() {
       widget.active_id = im_id();
     }
   }
+
+  resolve_mouse_events();
 }
 
 void new_frame() {
@@ -379,36 +702,66 @@ void new_frame() {
 
   // TODO: frame delta
 
-  auto const screen_rect = im_rect(0, 0, ::tb_width() - 1, ::tb_height() - 1);
+  auto const screen_rect = get_screen_rect();
 
   g_ctx->hash_id.reset();
   g_ctx->theme.reset();
+
+  // reload changed theme file, keep current theme on read error
+  if (g_ctx->theme_file.changed()) {
+    if (im_theme_file::colors colors; g_ctx->theme_file.read(colors)) {
+      apply_theme(colors);
+    }
+  }
   g_ctx->layout.reset(screen_rect);
+  g_ctx->hit_index.reset(screen_rect);
+  g_ctx->grid_count = 0;
 
   g_ctx->view.current_title = "N/A";
   g_ctx->view.current_id = im_id();
   g_ctx->view.current_flags = 0;
   g_ctx->view.force_next_id = im_id();
   g_ctx->view.active = false;
+  g_ctx->view.skipped = false;
 
   g_ctx->widget.current_id = im_id();
   g_ctx->widget.first_id = im_id();
   g_ctx->widget.next_id = im_id();
   g_ctx->widget.active = false;
   g_ctx->widget.pressed = false;
+  g_ctx->widget.hovered = false;
+  g_ctx->widget.clicked = false;
+  g_ctx->widget.dragged = false;
 
   auto const now = im_clock::now();
   g_ctx->elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - g_ctx->last_frame_time).count() * 0.001f;
   g_ctx->last_frame_time = now;
 
-  g_ctx->renderer.set_clear_color(g_ctx->theme.get_style(im_color_id::text, im_color_id::background));
+  g_ctx->text_cache.new_frame();
+  g_ctx->text_layout_cache.new_frame();
+  g_ctx->flex_layout_cache.new_frame();
+  g_ctx->renderer.set_clear_color(g_ctx->theme.get_style(im_style_id::text));
   g_ctx->renderer.start_new_frame(screen_rect);
 }
 
 void render() {
   assert(g_ctx);
 
-  g_ctx->renderer.render();
+  auto const lock = std::lock_guard(g_ctx->input_thread.terminal_mutex);
+  g_ctx->renderer.render(im_vec2(::tb_width(), ::tb_height()), g_ctx->frame_stats);
+
+  g_ctx->frame_stats.text_cache_hits = g_ctx->text_cache.hits();
+  g_ctx->frame_stats.text_cache_misses = g_ctx->text_cache.misses();
+  g_ctx->text_cache.reset_stats();
+  g_ctx->frame_stats.stack_grows = std::exchange(im_stack_grow_count, 0);
+  g_ctx->frame_stats.arena_overflows = g_ctx->frame_resource.upstream_allocations();
+  g_ctx->frame_resource.reset_stats();
+  g_ctx->frame_stats.input_events = g_ctx->input.get_input_events().size();
+}
+
+auto get_frame_stats() -> im_frame_stats const& {
+  assert(g_ctx);
+  return g_ctx->frame_stats;
 }
 
 void debug() {
@@ -421,6 +774,7 @@ void debug() {
 }
 
 auto get_screen_rect() -> im_rect {
+  auto const lock = std::lock_guard(g_ctx->input_thread.terminal_mutex);
   return im_rect(0, 0, ::tb_width() - 1, ::tb_height() - 1);
 }
 
@@ -428,6 +782,65 @@ auto is_key_pressed(im_key_id id) -> bool {
   return g_ctx->input.is_key_pressed(id);
 }
 
+auto bind_keys(std::string_view keys, std::string_view action, std::string_view view) -> bool {
+  std::array<im_keymap::key_code, im_keymap::max_sequence_length> sequence;
+  auto size = std::size_t(0);
+  for (auto const token : std::views::split(keys, ' ')) {
+    auto const key = std::string_view(token);
+    if (key.empty()) {
+      continue;
+    }
+    auto const code = im_keymap::parse_key_code(key);
+    if (!code || size == sequence.size()) {
+      return false;
+    }
+    sequence[size++] = *code;
+  }
+  if (size == 0) {
+    return false;
+  }
+
+  // ids of top-level view and action (see im_hash_id::reset(...))
+  auto const scope = view.empty() ? im_id() : im_id(hash(std::get<1>(im_hash_id::split_str_key(view)), 0));
+  g_ctx->keymap.bind(scope, std::span(sequence).first(size), im_id(hash(action, 0)));
+  return true;
+}
+
+auto is_action_triggered(std::string_view action) -> bool {
+  return g_ctx->keymap.is_triggered(im_id(hash(action, 0)));
+}
+
+auto is_item_hovered() -> bool {
+  return g_ctx->widget.hovered;
+}
+
+auto is_item_clicked() -> bool {
+  return g_ctx->widget.clicked;
+}
+
+auto is_item_dragged() -> bool {
+  return g_ctx->widget.dragged;
+}
+
+auto get_mouse_drag_delta() -> im_vec2 {
+  if (g_ctx->mouse.captured_id == im_id()) {
+    return im_vec2(0, 0);
+  }
+  return g_ctx->input.mouse_pos() - g_ctx->mouse.drag_origin;
+}
+
+auto load_theme(std::string_view path, bool watch) -> bool {
+  if (!g_ctx->theme_file.open(path, watch)) {
+    return false;
+  }
+  im_theme_file::colors colors;
+  if (!g_ctx->theme_file.read(colors)) {
+    return false;
+  }
+  apply_theme(colors);
+  return true;
+}
+
 void set_default_color(im_color_id id, im_color color) {
   g_ctx->theme.set_default_color(id, color);
 }
@@ -446,7 +859,7 @@ void layout_row_begin(std::size_t columns) {
     return;
   }
 
-  auto const& parent_layout = g_ctx->layout.layout_state_stack.back();
+  auto const parent_layout = g_ctx->layout.layout_state_stack.back();
   auto& row_layout = g_ctx->layout.layout_state_stack.emplace_back();
 
   // reset cursor to start of container layout
@@ -455,16 +868,32 @@ void layout_row_begin(std::size_t columns) {
   row_layout.type = im_layout_type::row;
   row_layout.rect.min = g_ctx->layout.cursor;
   row_layout.rect.max = im_vec2(parent_layout.rect.max.x, g_ctx->layout.cursor.y);
-  row_layout.row = im_layout_data_row{.columns = int(columns), .index = 0, .cursor_max_y = g_ctx->layout.cursor.y};
+  row_layout.row = im_layout_data_row{
+      .columns = int(columns), .index = 0, .cursor_max_y = g_ctx->layout.cursor.y, .widths = nullptr};
 
   // at this point
   // row_layout.rect.max.x != row_layout.rect.min.x -> layout width set
   // row_layout.rect.max.y == row_layout.rect.min.y -> layout height unset (dynamic)
 }
 
-void layout_row_push(float ratio_or_width) {
-  ratio_or_width = std::max<float>(0.0f, ratio_or_width);
+void layout_row_begin(std::span<im_flex const> columns) {
+  layout_row_begin(columns.size());
+  if (columns.empty()) [[unlikely]] {
+    return;
+  }
+
+  auto& row_layout = g_ctx->layout.layout_state_stack.back();
+  auto const solution = g_ctx->flex_layout_cache.get(columns, row_layout.rect.width());
+  // solution is valid until next get(...), nested rows need own copy
+  if (auto const widths = g_ctx->allocator.allocate<int>(solution.size()); widths) [[likely]] {
+    std::ranges::copy(solution, widths);
+    row_layout.row.widths = widths;
+  }
+}
+
+namespace internal {
 
+void layout_row_push_column(int width) {
   // offset position x since previous column
   int offset_min_x = 0;
   if (auto& column_layout = g_ctx->layout.layout_state_stack.back(); column_layout.type == im_layout_type::column) {
@@ -487,22 +916,45 @@ void layout_row_push(float ratio_or_width) {
   // update cursor max y
   row_layout.row.cursor_max_y = std::max(row_layout.row.cursor_max_y, g_ctx->layout.cursor.y);
 
-  auto const width =
-      ratio_or_width > 1.0f ? int(ratio_or_width) : int(std::ceil(ratio_or_width * row_layout.rect.width()));
+  if (width < 0) {
+    // flex row column (equal share if solution is not available)
+    width = row_layout.row.widths ? row_layout.row.widths[row_layout.row.index]
+                                  : row_layout.rect.width() / row_layout.row.columns;
+  }
   auto const offset_max_x = std::min<int>(offset_min_x + width - 1, row_layout.rect.max.x);
+  auto const offset_y = row_layout.rect.min.y;
+
+  row_layout.row.index++;
 
+  // row_layout is invalidated on stack growth
   auto& column_layout = g_ctx->layout.layout_state_stack.emplace_back();
   column_layout.type = im_layout_type::column;
-  column_layout.rect.min = im_vec2(offset_min_x, row_layout.rect.min.y);
-  column_layout.rect.max = im_vec2(offset_max_x, row_layout.rect.min.y);
+  column_layout.rect.min = im_vec2(offset_min_x, offset_y);
+  column_layout.rect.max = im_vec2(offset_max_x, offset_y);
   column_layout.none = {};
 
-  row_layout.row.index++;
-
   g_ctx->layout.cursor = column_layout.rect.min;
   g_ctx->layout.last_cursor_y = g_ctx->layout.cursor.y;
 }
 
+} // namespace internal
+
+void layout_row_push(float ratio_or_width) {
+  ratio_or_width = std::max<float>(0.0f, ratio_or_width);
+
+  auto const& stack = g_ctx->layout.layout_state_stack;
+  // row is parent of current column
+  auto const& row_layout = stack.back().type == im_layout_type::column ? stack[stack.size() - 2] : stack.back();
+
+  auto const width =
+      ratio_or_width > 1.0f ? int(ratio_or_width) : int(std::ceil(ratio_or_width * row_layout.rect.width()));
+  internal::layout_row_push_column(width);
+}
+
+void layout_row_push() {
+  internal::layout_row_push_column(-1);
+}
+
 void layout_row_end() {
   if (auto& column_layout = g_ctx->layout.layout_state_stack.back(); column_layout.type == im_layout_type::column) {
     g_ctx->layout.layout_state_stack.pop_back();
@@ -523,25 +975,160 @@ void layout_row_end() {
   g_ctx->layout.last_cursor_y = g_ctx->layout.cursor.y;
 }
 
+void grid_begin(std::span<im_flex const> columns, int rows, int row_height) {
+  if (columns.empty() || rows <= 0 || row_height < 0) [[unlikely]] {
+    assert(false && "grid_begin(...) invalid argument");
+    return;
+  }
+
+  auto const& parent_layout = g_ctx->layout.layout_state_stack.back();
+  auto const cursor_y = g_ctx->layout.cursor.y;
+  auto const min_x = parent_layout.rect.min.x;
+  auto const max_x = parent_layout.rect.max.x;
+
+  // rows heights are measured on previous frame, like columns tracks
+  auto& state = g_ctx->grid_states[g_ctx->hash_id.make(g_ctx->grid_count++)];
+  if (state.row_heights.size() < std::size_t(rows)) {
+    state.row_heights.resize(std::size_t(rows), 1);
+  }
+
+  // columns offsets live in frame arena (cache solution is valid until next lookup)
+  auto const widths = g_ctx->flex_layout_cache.get(columns, max_x - min_x + 1);
+  auto const offsets = g_ctx->allocator.allocate<int>(widths.size() + 1);
+  if (!offsets) [[unlikely]] {
+    assert(false && "grid_begin(...) frame arena exhausted");
+    return;
+  }
+  offsets[0] = min_x;
+  for (auto const i : std::views::iota(std::size_t(0), widths.size())) {
+    offsets[i + 1] = std::min(offsets[i] + widths[i], max_x + 1);
+  }
+
+  auto& grid_layout = g_ctx->layout.layout_state_stack.emplace_back();
+  grid_layout.type = im_layout_type::grid;
+  grid_layout.rect.min = im_vec2(min_x, cursor_y);
+  grid_layout.rect.max = im_vec2(max_x, cursor_y);
+  grid_layout.grid = im_layout_data_grid{.columns = int(columns.size()),
+      .rows = rows,
+      .offsets = offsets,
+      .row = 0,
+      .row_y = cursor_y,
+      .row_height = row_height,
+      .cursor_max_y = cursor_y,
+      .row_heights = state.row_heights.data()};
+}
+
+void grid_cell(int column, int row) {
+  auto& stack = g_ctx->layout.layout_state_stack;
+
+  // cell layout is reused for all cells of grid
+  auto const has_cell = stack.back().type == im_layout_type::column;
+  auto& grid_layout = has_cell ? stack[stack.size() - 2] : stack.back();
+  if (grid_layout.type != im_layout_type::grid) [[unlikely]] {
+    assert(false && "grid_cell(...) out of order");
+    return;
+  }
+  auto& grid = grid_layout.grid;
+  if (column < 0 || column >= grid.columns || row < grid.row || row >= grid.rows) [[unlikely]] {
+    assert(false && "grid_cell(...) invalid cell");
+    return;
+  }
+
+  grid.cursor_max_y = std::max(grid.cursor_max_y, g_ctx->layout.cursor.y);
+  if (row != grid.row) {
+    // next row starts below tallest cell (or after fixed height rows)
+    if (grid.row_height > 0) {
+      grid.row_y += (row - grid.row) * grid.row_height;
+    } else {
+      grid.row_heights[grid.row] = std::max(1, grid.cursor_max_y - grid.row_y);
+      grid.row_y = grid.cursor_max_y;
+    }
+    grid.cursor_max_y = grid.row_y;
+    grid.row = row;
+  }
+
+  // all cells of row span row height, content height is known on next frame for dynamic rows
+  auto const height = grid.row_height > 0 ? grid.row_height : grid.row_heights[row];
+  auto const cell_rect =
+      im_rect(grid.offsets[column], grid.row_y, grid.offsets[column + 1] - 1, grid.row_y + height - 1);
+  if (g_ctx->renderer.is_visible(cell_rect)) {
+    g_ctx->renderer.cmd_fill_rect(cell_rect, ' ', g_ctx->theme.get_style(im_style_id::text));
+  }
+
+  // grid_layout is invalidated on stack growth
+  auto& cell_layout = has_cell ? stack.back() : stack.emplace_back();
+  cell_layout.type = im_layout_type::column;
+  cell_layout.rect = cell_rect;
+  cell_layout.none = {};
+
+  g_ctx->layout.cursor = cell_layout.rect.min;
+  g_ctx->layout.last_cursor_y = g_ctx->layout.cursor.y;
+  g_ctx->layout.same_line = false;
+}
+
+void grid_end() {
+  auto& stack = g_ctx->layout.layout_state_stack;
+  auto const cursor_y = g_ctx->layout.cursor.y;
+  if (stack.back().type == im_layout_type::column) {
+    stack.pop_back();
+  }
+
+  auto const& grid_layout = stack.back();
+  if (grid_layout.type != im_layout_type::grid) [[unlikely]] {
+    assert(false && "grid_end(...) out of order");
+    return;
+  }
+
+  auto const& grid = grid_layout.grid;
+  auto const end_y = grid.row_height > 0 ? grid.row_y + grid.row_height : std::max(grid.cursor_max_y, cursor_y);
+  if (grid.row_height == 0) {
+    grid.row_heights[grid.row] = std::max(1, end_y - grid.row_y);
+  }
+  stack.pop_back();
+
+  auto const& parent_layout = stack.back();
+  g_ctx->layout.cursor = im_vec2(parent_layout.rect.min.x, end_y);
+  g_ctx->layout.last_cursor_y = g_ctx->layout.cursor.y;
+}
+
 void same_line() {
   g_ctx->layout.same_line = true;
 }
 
-void view_begin(std::string_view name, int flags, im_key_id shortcut) {
+auto view_begin(std::string_view name, int flags, im_key_id shortcut, int height) -> bool {
   auto& view = g_ctx->view;
   if (view.current_id != im_id()) {
     assert(false && "view_begin(...) inside another view");
-    return;
+    return false;
   }
+  view.skipped = false;
 
   auto const [str, view_key] = g_ctx->hash_id.split_str_key(name);
+  auto const view_id = g_ctx->hash_id.make(view_key);
+  auto& state = g_ctx->view_states[view_id];
+
+  auto const collapsible = (im_view_flag_collapsible == (flags & im_view_flag_collapsible));
+  auto const parent_layout = g_ctx->layout.layout_state_stack.back();
+  auto const top_rect =
+      im_rect(parent_layout.rect.min.x, g_ctx->layout.cursor.y, parent_layout.rect.max.x, g_ctx->layout.cursor.y);
+
+  if (collapsible) {
+    // click on the top line toggles view, shortcut always expands it
+    if (is_mouse_clicked(g_ctx->renderer.visible_rect(top_rect))) {
+      state.collapsed = !state.collapsed;
+    }
+    if (shortcut != im_key_id() && is_key_pressed(shortcut)) {
+      state.collapsed = false;
+    }
+  }
 
+  auto const title_prefix = collapsible ? (state.collapsed ? "▸ " : "▾ ") : "";
   if (shortcut != im_key_id()) {
-    view.current_title = std::format(" {} <{}> ", str, get_shorcut_label(shortcut));
+    view.current_title = format_to_frame(" {}{} <{}> ", title_prefix, str, get_key_label(shortcut));
   } else {
-    view.current_title = std::format(" {} ", str);
+    view.current_title = format_to_frame(" {}{} ", title_prefix, str);
   }
-  view.current_id = g_ctx->hash_id.push_id(view_key);
+  view.current_id = view_id;
   view.current_flags = flags;
 
   if (view.active_id == im_id()) {
@@ -552,11 +1139,43 @@ void view_begin(std::string_view name, int flags, im_key_id shortcut) {
   if (is_key_pressed(shortcut) && !view.active) {
     view.force_next_id = view.current_id;
   }
-  // TODO: skip frame?
+
+  if (collapsible && state.collapsed) {
+    // collapsed view is a single title line
+    if (g_ctx->renderer.is_visible(top_rect)) {
+      auto const style = view.active
+                             ? g_ctx->theme.get_style(im_style_id::view_active_title)
+                             : g_ctx->theme.get_style(im_style_id::view_inactive_title);
+      if (im_view_flag_border == (flags & im_view_flag_border)) {
+        g_ctx->renderer.cmd_fill_rect(top_rect, L'─',
+            view.active ? g_ctx->theme.get_style(im_style_id::view_active_border)
+                        : g_ctx->theme.get_style(im_style_id::view_inactive_border));
+      } else {
+        g_ctx->renderer.cmd_fill_rect(top_rect, ' ', style);
+      }
+      auto const title = to_text_metrics(view.current_title);
+      g_ctx->renderer.cmd_draw_text_in_rect(
+          top_rect, title.text, title.width, style, im_halign::center, im_valign::top);
+    }
+    state.height = 1;
+    view_skip(state.height);
+    return false;
+  }
+
+  if (state.height > 0) {
+    // whole view is out of clip rect, reserve height from previous frame
+    auto const view_rect = im_rect(top_rect.min, im_vec2(top_rect.max.x, top_rect.min.y + state.height - 1));
+    if (!g_ctx->renderer.is_visible(view_rect)) {
+      view_skip(state.height);
+      return false;
+    }
+  }
+
+  g_ctx->hash_id.push_id(view_key);
+  view.top_y = top_rect.min.y;
 
   // layout and visuals
   {
-    auto const& parent_layout = g_ctx->layout.layout_state_stack.back();
     auto& layout = g_ctx->layout.layout_state_stack.emplace_back();
 
     auto const do_render_border = (im_view_flag_border == (flags & im_view_flag_border));
@@ -577,30 +1196,65 @@ void view_begin(std::string_view name, int flags, im_key_id shortcut) {
     if (!do_render_border && do_render_title) {
       auto const title_rect = g_ctx->layout.reserve_layout_lines(1);
       auto const style = view.active
-                             ? g_ctx->theme.get_style(im_color_id::view_active_title, im_color_id::background)
-                             : g_ctx->theme.get_style(im_color_id::view_inactive_title, im_color_id::background);
+                             ? g_ctx->theme.get_style(im_style_id::view_active_title)
+                             : g_ctx->theme.get_style(im_style_id::view_inactive_title);
       g_ctx->renderer.cmd_fill_rect(title_rect, ' ', style);
+      auto const title = to_text_metrics(view.current_title);
       g_ctx->renderer.cmd_draw_text_in_rect(
-          title_rect, to_unicode(view.current_title), style, im_halign::center, im_valign::top);
+          title_rect, title.text, title.width, style, im_halign::center, im_valign::top);
     }
 
     // shrink available clip rect by layout width
     auto clip_rect = g_ctx->renderer.clip_rect();
     clip_rect.min.x = layout.rect.min.x;
     clip_rect.max.x = layout.rect.max.x;
+
+    if (flags & im_view_flag_scroll) {
+      view.scroll_origin_y = g_ctx->layout.cursor.y;
+      view.scroll_height = height > 0 ? height : std::max(1, clip_rect.max.y - border - view.scroll_origin_y + 1);
+      view.prev_viewport_offset = g_ctx->renderer.viewport_offset();
+
+      auto const visible_rect = im_rect(layout.rect.min.x, view.scroll_origin_y, layout.rect.max.x,
+          view.scroll_origin_y + view.scroll_height - 1);
+      auto const max_scroll = std::max(0, state.content_height - view.scroll_height);
+      auto const scroll_input = view_scroll_input(visible_rect.translate(-view.prev_viewport_offset), view.active);
+      state.scroll = std::clamp(state.scroll + scroll_input, 0, max_scroll);
+
+      // content below origin is shifted up by scroll offset and clipped by visible rect
+      g_ctx->renderer.set_viewport_offset(view.prev_viewport_offset + im_vec2(0, state.scroll));
+      clip_rect.min.y = std::max(clip_rect.min.y, visible_rect.min.y);
+      clip_rect.max.y = std::min(clip_rect.max.y, visible_rect.max.y);
+    }
+
     g_ctx->renderer.push_clip_rect(clip_rect);
   }
+
+  return true;
 }
 
 void view_end() {
   auto& view = g_ctx->view;
+  if (std::exchange(view.skipped, false)) {
+    // view_begin(...) returned false
+    return;
+  }
 
   g_ctx->hash_id.pop_id();
 
+  auto& state = g_ctx->view_states[view.current_id];
+
   // layout and visuals
   {
     g_ctx->renderer.pop_clip_rect();
 
+    if (view.current_flags & im_view_flag_scroll) {
+      state.content_height = g_ctx->layout.cursor.y - view.scroll_origin_y;
+
+      // view takes fixed height regardless of content
+      g_ctx->renderer.set_viewport_offset(view.prev_viewport_offset);
+      g_ctx->layout.cursor.y = view.scroll_origin_y + view.scroll_height;
+    }
+
     auto const do_render_border = (im_view_flag_border == (view.current_flags & im_view_flag_border));
     auto const do_render_title = (im_view_flag_title == (view.current_flags & im_view_flag_title));
 
@@ -619,16 +1273,17 @@ void view_end() {
 
     if (do_render_border) {
       auto const style = view.active
-                             ? g_ctx->theme.get_style(im_color_id::view_active_border, im_color_id::background)
-                             : g_ctx->theme.get_style(im_color_id::view_inactive_border, im_color_id::background);
+                             ? g_ctx->theme.get_style(im_style_id::view_active_border)
+                             : g_ctx->theme.get_style(im_style_id::view_inactive_border);
       g_ctx->renderer.cmd_draw_rect(panel_rect, style);
 
       if (do_render_title) {
         auto const style = view.active
-                               ? g_ctx->theme.get_style(im_color_id::view_active_title, im_color_id::background)
-                               : g_ctx->theme.get_style(im_color_id::view_inactive_title, im_color_id::background);
+                               ? g_ctx->theme.get_style(im_style_id::view_active_title)
+                               : g_ctx->theme.get_style(im_style_id::view_inactive_title);
+        auto const title = to_text_metrics(view.current_title);
         g_ctx->renderer.cmd_draw_text_in_rect(
-            panel_rect, to_unicode(view.current_title), style, im_halign::center, im_valign::top);
+            panel_rect, title.text, title.width, style, im_halign::center, im_valign::top);
       }
     }
 
@@ -636,6 +1291,9 @@ void view_end() {
     g_ctx->layout.cursor = im_vec2(parent_layout.rect.min.x, g_ctx->layout.cursor.y + border);
   }
 
+  // whole view height to reserve when view skipped
+  state.height = g_ctx->layout.cursor.y - view.top_y;
+
   view.current_title = "N/A";
   view.current_id = im_id();
   view.current_flags = 0;
@@ -645,7 +1303,7 @@ void view_end() {
 void panel_begin() {
   constexpr auto border = int(1);
 
-  auto const& parent_layout = g_ctx->layout.layout_state_stack.back();
+  auto const parent_layout = g_ctx->layout.layout_state_stack.back();
   auto& layout = g_ctx->layout.layout_state_stack.emplace_back();
 
   // reset cursor to start of container layout
@@ -673,7 +1331,7 @@ void panel_end() {
 
   g_ctx->layout.layout_state_stack.pop_back();
 
-  auto const style = g_ctx->theme.get_style(im_color_id::border, im_color_id::background);
+  auto const style = g_ctx->theme.get_style(im_style_id::border);
   g_ctx->renderer.cmd_draw_rect(panel_rect, style);
 
   // restore cursor position at x
@@ -681,17 +1339,75 @@ void panel_end() {
   g_ctx->layout.cursor = im_vec2(parent_layout.rect.min.x, g_ctx->layout.cursor.y + border);
 }
 
-void label(std::string_view text) {
-  auto const unicode_text = to_unicode(text);
-  auto const widget_rect = g_ctx->layout.add_widget_item(im_vec2(unicode_text.size(), 1));
+namespace internal {
+
+void label(im_text_metrics const& metrics, int flags) {
+  if ((flags & (im_label_flag_wrap | im_label_flag_ellipsis)) == 0) {
+    auto const widget_rect = g_ctx->layout.add_widget_item(im_vec2(metrics.width, 1));
+    if (!g_ctx->renderer.is_visible(widget_rect)) {
+      return;
+    }
+    auto const style = g_ctx->theme.get_style(im_style_id::text);
+    g_ctx->renderer.cmd_fill_rect(widget_rect, ' ', style);
+    g_ctx->renderer.cmd_draw_text_in_rect(
+        widget_rect, metrics.text, metrics.width, style, im_halign::left, im_valign::top);
+    return;
+  }
+
+  static constexpr std::uint32_t ellipsis[] = {im_ellipsis_ch};
+
+  auto const overflow = (flags & im_label_flag_wrap) ? im_text_overflow::wrap : im_text_overflow::ellipsis;
+  auto const lines = g_ctx->text_layout_cache.get(
+      metrics.hash, metrics.text, metrics.width, g_ctx->layout.available_width(), overflow);
+
+  auto widget_width = 0;
+  for (auto const& line : lines) {
+    widget_width = std::max(widget_width, line.width + (line.ellipsis ? 1 : 0));
+  }
+  auto const widget_rect = g_ctx->layout.add_widget_item(im_vec2(widget_width, int(lines.size())));
   if (!g_ctx->renderer.is_visible(widget_rect)) {
     return;
   }
-  auto const style = g_ctx->theme.get_style(im_color_id::text, im_color_id::background);
+  auto const style = g_ctx->theme.get_style(im_style_id::text);
   g_ctx->renderer.cmd_fill_rect(widget_rect, ' ', style);
-  g_ctx->renderer.cmd_draw_text_in_rect(widget_rect, unicode_text, style, im_halign::left, im_valign::top);
+  auto pos = widget_rect.min;
+  for (auto const& line : lines) {
+    auto const line_text = metrics.text.subspan(line.begin, line.end - line.begin);
+    g_ctx->renderer.cmd_draw_text_at(pos, line_text, line.width, style);
+    if (line.ellipsis) {
+      g_ctx->renderer.cmd_draw_text_at(im_vec2(pos.x + line.width, pos.y), ellipsis, 1, style);
+    }
+    pos.y++;
+  }
 }
 
+} // namespace internal
+
+void label(std::string_view text, int flags) {
+  internal::label(to_text_metrics(text), flags);
+}
+
+namespace detail {
+
+auto format_buffer() noexcept -> std::span<char> {
+  auto const buffer = g_ctx->allocator.free_space();
+  return std::span(reinterpret_cast<char*>(buffer.data()), buffer.size());
+}
+
+void labelf(std::size_t size) {
+  // formatted text is already in front of arena free space, just take it
+  auto const buffer = format_buffer();
+  size = std::min(size, buffer.size());
+  [[maybe_unused]] auto const utf8 = g_ctx->allocator.allocate<char>(size);
+  assert(utf8 == buffer.data() || size == 0);
+
+  // formatted values change every frame, don't pollute text and layout caches (text isn't hashed)
+  auto const text = to_unicode(std::string_view(buffer.data(), size));
+  internal::label(im_text_metrics{.text = text, .width = text_width(text)}, 0);
+}
+
+} // namespace detail
+
 namespace internal {
 
 // update widget.* properties
@@ -703,8 +1419,16 @@ void common_focusable_behaviour(im_id widget_id) noexcept {
   widget.pressed = false;
   widget.active = false;
 
-  // TODO:
-  // https://github.com/ksergey/xxx/blob/20b7cfdab337acda6e69290a8f4a9ee408ad8c37/code_v3/xxx.cpp#L306-L316
+  // mouse staff
+  auto const& mouse = g_ctx->mouse;
+  widget.hovered = (mouse.hot_id == widget_id);
+  widget.clicked = (mouse.clicked_id == widget_id);
+  widget.dragged = (mouse.captured_id == widget_id);
+
+  // register widget for hit testing on next frame
+  if (auto const rect = g_ctx->renderer.visible_rect(g_ctx->layout.widget_item.rect); rect) {
+    g_ctx->hit_index.add(widget_id, view.current_id, rect);
+  }
 
   // focus staff
   if (view.active) {
@@ -734,8 +1458,8 @@ auto button(std::string_view label) -> bool {
   auto& widget = g_ctx->widget;
 
   auto const [str, widget_key] = g_ctx->hash_id.split_str_key(label);
-  auto const unicode_str = to_unicode(str);
-  auto const button_width = std::max<int>(button_min_width, unicode_str.size() + 4);
+  auto const [unicode_str, unicode_str_width, unicode_str_hash] = to_text_metrics(str);
+  auto const button_width = std::max<int>(button_min_width, unicode_str_width + 4);
   auto const widget_rect = g_ctx->layout.add_widget_item(im_vec2(button_width, 1));
 
   internal::common_focusable_behaviour(g_ctx->hash_id.make(widget_key));
@@ -745,38 +1469,277 @@ auto button(std::string_view label) -> bool {
       widget.pressed = true;
     }
   }
+  if (widget.clicked) {
+    widget.pressed = true;
+  }
 
   if (g_ctx->renderer.is_visible(widget_rect)) {
     // fill background
     g_ctx->renderer.cmd_fill_rect(widget_rect, ' ',
-        widget.active ? get_style_bg(im_color_id::button_active_background)
-                      : get_style_bg(im_color_id::button_inactive_background));
+        widget.active ? get_style(im_style_id::button_active_background)
+                      : get_style(im_style_id::button_inactive_background));
 
     // label start pos
-    auto const unicode_str_pos = widget_rect.min + im_vec2((widget_rect.width() - unicode_str.size()) / 2, 0);
+    auto const unicode_str_pos = widget_rect.min + im_vec2((widget_rect.width() - unicode_str_width) / 2, 0);
 
     // draw label
-    g_ctx->renderer.cmd_draw_text_at(unicode_str_pos, unicode_str,
-        widget.active ? get_style(im_color_id::button_active_text, im_color_id::button_active_background)
-                      : get_style(im_color_id::button_inactive_text, im_color_id::button_inactive_background));
+    g_ctx->renderer.cmd_draw_text_at(unicode_str_pos, unicode_str, unicode_str_width,
+        widget.active ? get_style(im_style_id::button_active_text) : get_style(im_style_id::button_inactive_text));
 
     // draw left fx
     g_ctx->renderer.cmd_draw_text_at(unicode_str_pos - im_vec2(2, 0), std::span<std::uint32_t const>(&fx_left_ch, 1),
-        widget.active ? get_style(im_color_id::button_active_fx, im_color_id::button_active_background)
-                      : get_style(im_color_id::button_inactive_fx, im_color_id::button_inactive_background));
+        widget.active ? get_style(im_style_id::button_active_fx) : get_style(im_style_id::button_inactive_fx));
 
     // draw right fx
-    g_ctx->renderer.cmd_draw_text_at(unicode_str_pos + im_vec2(2 + unicode_str.size() - 1, 0),
+    g_ctx->renderer.cmd_draw_text_at(unicode_str_pos + im_vec2(2 + unicode_str_width - 1, 0),
         std::span<std::uint32_t const>(&fx_right_ch, 1),
-        widget.active ? get_style(im_color_id::button_active_fx, im_color_id::button_active_background)
-                      : get_style(im_color_id::button_inactive_fx, im_color_id::button_inactive_background));
+        widget.active ? get_style(im_style_id::button_active_fx) : get_style(im_style_id::button_inactive_fx));
   }
 
   return widget.pressed;
 }
 
+namespace internal {
+
+constexpr auto text_input_prompt = std::string_view("> ");
+
+// copy part of text buffer into frame allocator
+[[nodiscard]] auto to_unicode(im_text_buffer const& buffer, std::size_t pos, std::size_t count) noexcept
+    -> std::span<std::uint32_t const> {
+  count = std::min(count, buffer.size() - std::min(pos, buffer.size()));
+  auto const output = g_ctx->allocator.allocate<std::uint32_t>(count);
+  if (!output) [[unlikely]] {
+    return std::span<std::uint32_t const>();
+  }
+  return std::span<std::uint32_t const>(output, buffer.copy(pos, count, output));
+}
+
+// replace control chars (line breaks and tabs) of pasted text with spaces
+// result is valid until next call
+[[nodiscard]] auto paste_text(std::span<std::uint32_t const> text, bool keep_line_breaks)
+    -> std::span<std::uint32_t const> {
+  auto const is_control = [keep_line_breaks](std::uint32_t ch) noexcept {
+    return ch < ' ' && !(keep_line_breaks && ch == '\n');
+  };
+
+  if (std::ranges::none_of(text, is_control)) [[likely]] {
+    return text;
+  }
+  auto output = g_ctx->allocator.allocate<std::uint32_t>(text.size());
+  if (!output) [[unlikely]] {
+    // frame arena can't hold large paste, use heap buffer (kept for next pastes)
+    g_ctx->paste.sanitized.resize(text.size());
+    output = g_ctx->paste.sanitized.data();
+  }
+  std::ranges::replace_copy_if(text, output, is_control, std::uint32_t(' '));
+  return std::span<std::uint32_t const>(output, text.size());
+}
+
+// handle input events for active text input
+// @return true on text changed
+auto text_input_edit(im_text_buffer& buffer) -> bool {
+  auto& widget = g_ctx->widget;
+  auto& text_input = g_ctx->text_input;
+
+  static constexpr auto is_blank = [](std::uint32_t ch) noexcept {
+    return ch == ' ' || ch == '\t';
+  };
+
+  if (int const text_length = buffer.size(); text_input.cursor_pos > text_length) {
+    text_input.cursor_pos = text_length;
+  }
+  if (is_key_pressed(im_key_id::enter)) {
+    widget.pressed = true;
+  }
+
+  auto text_changed = false;
+  for (auto const& event : g_ctx->input.get_input_events()) {
+    if (event.type == im_input_event_type::character) {
+      buffer.insert(text_input.cursor_pos, event.ch);
+      text_input.cursor_pos++;
+      text_changed = true;
+    } else if (event.type == im_input_event_type::paste) {
+      auto const text = paste_text(g_ctx->input.get_paste_text(event), false);
+      buffer.insert(text_input.cursor_pos, text);
+      text_input.cursor_pos += text.size();
+      text_changed = true;
+    } else if (event.type == im_input_event_type::key) {
+      switch (event.key) {
+      case im_key_id::backspace:
+      case im_key_id::backspace2: {
+        if (text_input.cursor_pos > 0) {
+          text_input.cursor_pos--;
+          buffer.erase(text_input.cursor_pos);
+          text_changed = true;
+        }
+      } break;
+      case im_key_id::del: {
+        if (int const text_length = buffer.size(); text_input.cursor_pos < text_length) {
+          buffer.erase(text_input.cursor_pos);
+          text_changed = true;
+        }
+      } break;
+      case im_key_id::arrow_left: {
+        if (text_input.cursor_pos > 0) {
+          text_input.cursor_pos--;
+        }
+      } break;
+      case im_key_id::arrow_right: {
+        if (int const text_length = buffer.size(); text_input.cursor_pos < text_length) {
+          text_input.cursor_pos++;
+        }
+      } break;
+      case im_key_id::home: {
+        text_input.cursor_pos = 0;
+        text_input.scroll_offset = 0;
+      } break;
+      case im_key_id::end: {
+        text_input.cursor_pos = buffer.size();
+      } break;
+      case im_key_id::ctrl_w: {
+        if (!buffer.empty()) {
+          // erase range end (exclusive)
+          auto last = text_input.cursor_pos;
+          if (auto const text_length = int(buffer.size()); last >= text_length) {
+            // on end of input erase from last char
+            last = text_length;
+          } else if (is_blank(buffer[last])) {
+            // erase blank symbol under cursor
+            last++;
+          }
+          // drop blanks before cursor, then drop until blank
+          auto first = last;
+          while (first > 0 && is_blank(buffer[first - 1])) {
+            first--;
+          }
+          while (first > 0 && !is_blank(buffer[first - 1])) {
+            first--;
+          }
+          buffer.erase(first, last - first);
+          text_input.cursor_pos = first;
+          text_changed = true;
+        }
+      } break;
+      default:
+        break;
+      }
+    }
+  }
+
+  assert(text_input.cursor_pos <= (int)buffer.size());
+
+  return text_changed;
+}
+
+// scroll active text input to cursor
+// @return visible part of text and cursor position inside it
+[[nodiscard]] auto text_input_visible_text(im_text_buffer const& buffer, int display_width)
+    -> std::tuple<std::span<std::uint32_t const>, int> {
+  auto& text_input = g_ctx->text_input;
+
+  auto scroll_offset = 0;
+  if (int(buffer.size()) + 1 > display_width) {
+    // context is greater of widget rect
+    constexpr auto step = int(3);
+
+    if (text_input.cursor_pos < text_input.scroll_offset) {
+      text_input.scroll_offset = text_input.cursor_pos - step;
+    } else if (auto const abs_cursor_pos = text_input.cursor_pos + 1 - text_input.scroll_offset;
+        abs_cursor_pos > display_width) {
+      text_input.scroll_offset += abs_cursor_pos - display_width + step;
+    }
+    text_input.scroll_offset = std::max<int>(text_input.scroll_offset, 0);
+    scroll_offset = text_input.scroll_offset;
+  }
+
+  return std::make_tuple(to_unicode(buffer, scroll_offset, display_width), text_input.cursor_pos - scroll_offset);
+}
+
+// draw text input
+//   content - visible part of text
+//   cursor_pos - cursor position inside content (active widget only)
+void text_input_draw(im_rect const& widget_rect, std::string_view placeholder, bool active, bool empty,
+    std::span<std::uint32_t const> content, int cursor_pos) {
+  auto const prompt = xxx::to_unicode(text_input_prompt);
+  auto rect = widget_rect;
+
+  if (active) {
+    // fill background
+    g_ctx->renderer.cmd_fill_rect(rect, ' ', get_style(im_style_id::input_active_background));
+    // draw prompt
+    g_ctx->renderer.cmd_draw_text_at(rect.min, prompt, get_style(im_style_id::input_active_prompt));
+  } else {
+    // fill background
+    g_ctx->renderer.cmd_fill_rect(rect, ' ', get_style(im_style_id::input_inactive_background));
+    // draw prompt
+    g_ctx->renderer.cmd_draw_text_at(rect.min, prompt, get_style(im_style_id::input_inactive_prompt));
+  }
+
+  rect.min += im_vec2(prompt.size(), 0);
+
+  // "static" keywoard is required here
+  static constexpr auto space_ch = std::uint32_t(' ');
+
+  if (empty) {
+    auto const unicode_str = substr(xxx::to_unicode(placeholder), 0, rect.width());
+
+    if (active) {
+      if (!unicode_str.empty()) {
+        {
+          auto const style = get_style(im_style_id::input_active_text).with_reverse();
+          g_ctx->renderer.cmd_draw_text_at(rect.min, substr(unicode_str, 0, 1), style);
+        }
+        rect.min += im_vec2(1, 0);
+        {
+          auto const style = get_style(im_style_id::input_active_placeholder);
+          g_ctx->renderer.cmd_draw_text_at(rect.min, substr(unicode_str, 1), style);
+        }
+      } else {
+        auto const style = get_style(im_style_id::input_active_text).with_reverse();
+        g_ctx->renderer.cmd_draw_text_at(rect.min, std::span<std::uint32_t const>(&space_ch, 1), style);
+      }
+    } else {
+      if (!unicode_str.empty()) {
+        auto const style = get_style(im_style_id::input_inactive_placeholder);
+        g_ctx->renderer.cmd_draw_text_at(rect.min, unicode_str, style);
+      }
+    }
+  } else {
+    if (active) {
+      auto const style = g_ctx->theme.get_style(im_style_id::input_active_text);
+      auto const cursor_style = style.with_reverse();
+      g_ctx->renderer.cmd_fill_rect(rect, ' ', style);
+
+      auto const content_size = int(content.size());
+
+      if (cursor_pos < content_size) {
+        if (cursor_pos > 0) {
+          g_ctx->renderer.cmd_draw_text_at(rect.min, substr(content, 0, cursor_pos), style);
+        }
+        g_ctx->renderer.cmd_draw_text_at(
+            rect.min + im_vec2(cursor_pos, 0), substr(content, cursor_pos, 1), cursor_style);
+        if (cursor_pos + 1 < content_size) {
+          g_ctx->renderer.cmd_draw_text_at(
+              rect.min + im_vec2(cursor_pos + 1, 0), substr(content, cursor_pos + 1), style);
+        }
+      } else {
+        g_ctx->renderer.cmd_draw_text_at(rect.min, content, style);
+        g_ctx->renderer.cmd_draw_text_at(
+            rect.min + im_vec2(content_size, 0), std::span<std::uint32_t const>(&space_ch, 1), cursor_style);
+      }
+    } else {
+      auto const style = g_ctx->theme.get_style(im_style_id::input_inactive_text);
+      g_ctx->renderer.cmd_fill_rect(rect, ' ', style);
+      g_ctx->renderer.cmd_draw_text_at(rect.min, substr(content, 0, rect.width()), style);
+    }
+  }
+}
+
+} // namespace internal
+
 auto text_input(std::string_view placeholder, std::string& input, [[maybe_unused]] int flags) -> bool {
   static constexpr int input_width = 16;
+  static constexpr int display_width = input_width - int(internal::text_input_prompt.size());
 
   auto& widget = g_ctx->widget;
   auto& text_input = g_ctx->text_input;
@@ -787,201 +1750,273 @@ auto text_input(std::string_view placeholder, std::string& input, [[maybe_unused
   internal::common_focusable_behaviour(g_ctx->hash_id.make(widget_key));
 
   if (widget.active) {
-    text_input.text.clear();
-    to_unicode(input, std::back_inserter(text_input.text));
-
     if (text_input.active_id != widget.active_id) {
       text_input.active_id = widget.active_id;
-      text_input.cursor_pos = text_input.text.size();
+      text_input.buffer.assign(input);
+      text_input.cursor_pos = text_input.buffer.size();
       text_input.scroll_offset = 0;
+      text_input.synced_version = text_input.buffer.version();
+      text_input.synced_data = input.data();
+      text_input.synced_size = input.size();
+    } else if (input.data() != text_input.synced_data || input.size() != text_input.synced_size) {
+      // input changed outside of widget (O(1) check, same size in-place edits are not seen)
+      text_input.buffer.assign(input);
+      text_input.synced_version = text_input.buffer.version();
+      text_input.synced_data = input.data();
+      text_input.synced_size = input.size();
     }
-    if (int const text_length = text_input.text.size(); text_input.cursor_pos > text_length) {
-      text_input.cursor_pos = text_length;
-    }
-    if (is_key_pressed(im_key_id::enter)) {
-      widget.pressed = true;
+
+    internal::text_input_edit(text_input.buffer);
+    if (text_input.buffer.version() != text_input.synced_version) {
+      // copy back once per changed frame
+      input = text_input.buffer.str();
+      text_input.synced_version = text_input.buffer.version();
+      text_input.synced_data = input.data();
+      text_input.synced_size = input.size();
     }
+  }
 
-    auto text_changed = false;
-    for (auto const event : g_ctx->input.get_input_events()) {
-      if (event.ch > 0) {
-        text_input.text.insert(text_input.text.begin() + text_input.cursor_pos, event.ch);
-        text_input.cursor_pos++;
-        text_changed = true;
-      } else {
-        switch (event.key) {
-        case im_key_id::backspace:
-        case im_key_id::backspace2: {
-          if (text_input.cursor_pos > 0) {
-            text_input.cursor_pos--;
-            text_input.text.erase(text_input.text.begin() + text_input.cursor_pos);
-            text_changed = true;
-          }
-        } break;
-        case im_key_id::del: {
-          if (int const text_length = text_input.text.size(); text_input.cursor_pos < text_length) {
-            text_input.text.erase(text_input.text.begin() + text_input.cursor_pos);
-            text_changed = true;
-          }
-        } break;
-        case im_key_id::arrow_left: {
-          if (text_input.cursor_pos > 0) {
-            text_input.cursor_pos--;
-          }
-        } break;
-        case im_key_id::arrow_right: {
-          if (int const text_length = text_input.text.size(); text_input.cursor_pos < text_length) {
-            text_input.cursor_pos++;
-          }
-        } break;
-        case im_key_id::home: {
-          text_input.cursor_pos = 0;
-          text_input.scroll_offset = 0;
-        } break;
-        case im_key_id::end: {
-          text_input.cursor_pos = text_input.text.size();
-        } break;
-        case im_key_id::ctrl_w: {
-          if (!text_input.text.empty()) {
-            if (auto const text_length = int(text_input.text.size()); text_input.cursor_pos >= text_length) {
-              // on end of input move cursor to last char
-              text_input.cursor_pos = text_length - 1;
-            } else if (!std::isblank(text_input.text[text_input.cursor_pos])) {
-              // keep symbol under cursor if non blank
-              text_input.cursor_pos--;
-            }
-            // drop blanks before cursor
-            while (text_input.cursor_pos >= 0 && std::isblank(text_input.text[text_input.cursor_pos])) {
-              text_input.text.erase(text_input.text.begin() + text_input.cursor_pos--);
-            }
-            // drop until blank
-            while (text_input.cursor_pos >= 0 && !std::isblank(text_input.text[text_input.cursor_pos])) {
-              text_input.text.erase(text_input.text.begin() + text_input.cursor_pos--);
-            }
-            if (text_input.cursor_pos < 0) {
-              text_input.cursor_pos = 0;
-            } else {
-              text_input.cursor_pos += 1;
-            }
-            text_changed = true;
-          }
-        } break;
-        default:
-          break;
-        }
-      }
+  if (g_ctx->renderer.is_visible(widget_rect)) {
+    if (widget.active) {
+      auto const [content, cursor_pos] = internal::text_input_visible_text(text_input.buffer, display_width);
+      internal::text_input_draw(widget_rect, str, true, input.empty(), content, cursor_pos);
+    } else {
+      internal::text_input_draw(widget_rect, str, false, input.empty(), to_text_metrics(input).text, 0);
     }
+  }
+
+  return widget.pressed;
+}
+
+auto text_input(std::string_view placeholder, im_text_buffer& buffer, [[maybe_unused]] int flags) -> bool {
+  static constexpr int input_width = 16;
+  static constexpr int display_width = input_width - int(internal::text_input_prompt.size());
+
+  auto& widget = g_ctx->widget;
+  auto& text_input = g_ctx->text_input;
+
+  auto const widget_rect = g_ctx->layout.add_widget_item(im_vec2(input_width, 1));
+  auto const [str, widget_key] = g_ctx->hash_id.split_str_key(placeholder);
 
-    assert(text_input.cursor_pos <= (int)text_input.text.size());
+  internal::common_focusable_behaviour(g_ctx->hash_id.make(widget_key));
 
-    if (text_changed) {
-      input.clear();
-      to_utf8(text_input.text, std::back_inserter(input));
+  if (widget.active) {
+    if (text_input.active_id != widget.active_id) {
+      text_input.active_id = widget.active_id;
+      text_input.cursor_pos = buffer.size();
+      text_input.scroll_offset = 0;
     }
+
+    internal::text_input_edit(buffer);
   }
 
   if (g_ctx->renderer.is_visible(widget_rect)) {
-    auto const prompt = to_unicode("> ");
-    auto rect = widget_rect;
-
     if (widget.active) {
-      // fill background
-      g_ctx->renderer.cmd_fill_rect(rect, ' ', get_style_bg(im_color_id::input_active_background));
-      // draw prompt
-      g_ctx->renderer.cmd_draw_text_at(
-          rect.min, prompt, get_style(im_color_id::input_active_prompt, im_color_id::input_active_background));
+      auto const [content, cursor_pos] = internal::text_input_visible_text(buffer, display_width);
+      internal::text_input_draw(widget_rect, str, true, buffer.empty(), content, cursor_pos);
     } else {
-      // fill background
-      g_ctx->renderer.cmd_fill_rect(rect, ' ', get_style_bg(im_color_id::input_inactive_background));
-      // draw prompt
-      g_ctx->renderer.cmd_draw_text_at(
-          rect.min, prompt, get_style(im_color_id::input_inactive_prompt, im_color_id::input_inactive_background));
+      internal::text_input_draw(
+          widget_rect, str, false, buffer.empty(), internal::to_unicode(buffer, 0, display_width), 0);
     }
+  }
 
-    rect.min += im_vec2(prompt.size(), 0);
-
-    // "static" keywoard is required here
-    static constexpr auto space_ch = std::uint32_t(' ');
+  return widget.pressed;
+}
 
-    if (input.empty()) {
-      auto const unicode_str = substr(to_unicode(str), 0, rect.width());
+namespace internal {
 
-      if (widget.active) {
-        if (!unicode_str.empty()) {
-          {
-            auto const style =
-                get_style(im_color_id::input_active_text, im_color_id::input_active_background).with_reverse();
-            g_ctx->renderer.cmd_draw_text_at(rect.min, substr(unicode_str, 0, 1), style);
-          }
-          rect.min += im_vec2(1, 0);
-          {
-            auto const style = get_style(im_color_id::input_placeholder, im_color_id::input_active_background);
-            g_ctx->renderer.cmd_draw_text_at(rect.min, substr(unicode_str, 1), style);
-          }
-        } else {
-          auto const style =
-              get_style(im_color_id::input_active_text, im_color_id::input_active_background).with_reverse();
-          g_ctx->renderer.cmd_draw_text_at(rect.min, std::span<std::uint32_t const>(&space_ch, 1), style);
+// handle input events for active text editor
+// @return true on text changed
+auto text_editor_edit(im_text_editor_state& state, im_text_buffer& buffer) -> bool {
+  static constexpr auto line_break = std::uint32_t('\n');
+
+  auto const update_cursor_column = [&] {
+    state.cursor_column = state.cursor - state.line_begin(state.line_of(state.cursor));
+  };
+  auto const move_cursor_to_line = [&](std::size_t line) {
+    state.cursor = std::min(state.line_begin(line) + state.cursor_column, state.line_end(buffer, line));
+  };
+
+  auto text_changed = false;
+  for (auto const& event : g_ctx->input.get_input_events()) {
+    if (event.type == im_input_event_type::character) {
+      state.insert(buffer, std::span<std::uint32_t const>(&event.ch, 1));
+      update_cursor_column();
+      text_changed = true;
+    } else if (event.type == im_input_event_type::paste) {
+      state.insert(buffer, paste_text(g_ctx->input.get_paste_text(event), true));
+      update_cursor_column();
+      text_changed = true;
+    } else if (event.type == im_input_event_type::key) {
+      auto const line = state.line_of(state.cursor);
+
+      switch (event.key) {
+      case im_key_id::enter: {
+        state.insert(buffer, std::span<std::uint32_t const>(&line_break, 1));
+        update_cursor_column();
+        text_changed = true;
+      } break;
+      case im_key_id::backspace:
+      case im_key_id::backspace2: {
+        if (state.cursor > 0) {
+          state.erase(buffer, state.cursor - 1, 1);
+          update_cursor_column();
+          text_changed = true;
         }
-      } else {
-        if (!unicode_str.empty()) {
-          auto const style = get_style(im_color_id::input_placeholder, im_color_id::input_inactive_background);
-          g_ctx->renderer.cmd_draw_text_at(rect.min, unicode_str, style);
+      } break;
+      case im_key_id::del: {
+        if (state.cursor < buffer.size()) {
+          state.erase(buffer, state.cursor, 1);
+          text_changed = true;
         }
-      }
-    } else {
-      if (widget.active) {
-        auto const style = g_ctx->theme.get_style(im_color_id::input_active_text, im_color_id::input_active_background);
-        auto const cursor_style = style.with_reverse();
-        g_ctx->renderer.cmd_fill_rect(rect, ' ', style);
-
-        auto const display_width = rect.width();
-        auto a_content = std::span<std::uint32_t const>(text_input.text);
-        auto a_content_size = int(a_content.size());
-        auto a_cursor_pos = text_input.cursor_pos;
-
-        if (a_content_size + 1 > display_width) {
-          // context is greater of widget rect
-          constexpr auto step = int(3);
-
-          auto const abs_cursor_pos = a_cursor_pos + 1 - text_input.scroll_offset;
-          if (abs_cursor_pos < 0) {
-            text_input.scroll_offset -= abs_cursor_pos + step;
-          } else if (abs_cursor_pos > display_width) {
-            text_input.scroll_offset += abs_cursor_pos - display_width + step;
-          }
-          text_input.scroll_offset = std::max<int>(text_input.scroll_offset, 0);
-
-          a_content = substr(a_content, text_input.scroll_offset);
-          a_content_size = int(a_content.size());
-          a_cursor_pos = a_cursor_pos - text_input.scroll_offset;
+      } break;
+      case im_key_id::arrow_left: {
+        if (state.cursor > 0) {
+          state.cursor--;
+          update_cursor_column();
         }
-
-        if (a_cursor_pos < a_content_size) {
-          if (a_cursor_pos > 0) {
-            g_ctx->renderer.cmd_draw_text_at(rect.min, substr(a_content, 0, a_cursor_pos), style);
-          }
-          g_ctx->renderer.cmd_draw_text_at(
-              rect.min + im_vec2(a_cursor_pos, 0), substr(a_content, a_cursor_pos, 1), cursor_style);
-          if (a_cursor_pos + 1 < a_content_size) {
-            g_ctx->renderer.cmd_draw_text_at(
-                rect.min + im_vec2(a_cursor_pos + 1, 0), substr(a_content, a_cursor_pos + 1, display_width), style);
-          }
-        } else {
-          g_ctx->renderer.cmd_draw_text_at(rect.min, a_content, style);
-          g_ctx->renderer.cmd_draw_text_at(
-              rect.min + im_vec2(a_content_size, 0), std::span<std::uint32_t const>(&space_ch, 1), cursor_style);
+      } break;
+      case im_key_id::arrow_right: {
+        if (state.cursor < buffer.size()) {
+          state.cursor++;
+          update_cursor_column();
         }
-      } else {
-        auto const style =
-            g_ctx->theme.get_style(im_color_id::input_inactive_text, im_color_id::input_inactive_background);
-        g_ctx->renderer.cmd_fill_rect(rect, ' ', style);
-        g_ctx->renderer.cmd_draw_text_at(rect.min, substr(to_unicode(input), 0, rect.width()), style);
+      } break;
+      case im_key_id::arrow_up: {
+        if (line > 0) {
+          move_cursor_to_line(line - 1);
+        }
+      } break;
+      case im_key_id::arrow_down: {
+        if (line + 1 < state.line_count()) {
+          move_cursor_to_line(line + 1);
+        }
+      } break;
+      case im_key_id::home: {
+        state.cursor = state.line_begin(line);
+        update_cursor_column();
+      } break;
+      case im_key_id::end: {
+        state.cursor = state.line_end(buffer, line);
+        update_cursor_column();
+      } break;
+      default:
+        break;
       }
     }
   }
 
-  return widget.pressed;
+  return text_changed;
+}
+
+// part of text shown in display columns [first_column, first_column + width)
+// (wide character cut by first column is skipped)
+// @return visible text, its display width and its column relative to first_column
+[[nodiscard]] auto text_columns(std::span<std::uint32_t const> text, int first_column, int width) noexcept
+    -> std::tuple<std::span<std::uint32_t const>, int, int> {
+  auto pos = std::size_t(0);
+  auto column = 0;
+  while (pos < text.size() && column < first_column) {
+    auto const cluster = next_grapheme_cluster(text.subspan(pos));
+    pos += cluster.length;
+    column += cluster.width;
+  }
+  auto const offset = column - first_column;
+  auto const begin = pos;
+  auto visible_width = 0;
+  while (pos < text.size()) {
+    auto const cluster = next_grapheme_cluster(text.subspan(pos));
+    if (offset + visible_width + cluster.width > width) {
+      break;
+    }
+    pos += cluster.length;
+    visible_width += cluster.width;
+  }
+  return std::make_tuple(text.subspan(begin, pos - begin), visible_width, offset);
+}
+
+// draw visible lines of text editor
+void text_editor_draw(im_rect const& widget_rect, std::string_view placeholder, im_text_editor_state& state,
+    im_text_buffer const& buffer, bool active) {
+  auto const style = active ? get_style(im_style_id::input_active_text) : get_style(im_style_id::input_inactive_text);
+  g_ctx->renderer.cmd_fill_rect(widget_rect, ' ', style);
+
+  auto const width = widget_rect.width();
+  auto const height = widget_rect.height();
+  if (width < 1 || height < 1) {
+    // view is narrower than widget indent
+    return;
+  }
+
+  // cursor and horizontal scroll are in display columns
+  auto const cursor_line = int(state.line_of(state.cursor));
+  auto const cursor_line_begin = state.line_begin(cursor_line);
+  auto const cursor_column = text_width(to_unicode(buffer, cursor_line_begin, state.cursor - cursor_line_begin));
+
+  // keep cursor visible
+  auto& scroll = state.scroll;
+  if (active) {
+    scroll.y = std::clamp(scroll.y, cursor_line - height + 1, cursor_line);
+    scroll.x = std::clamp(scroll.x, cursor_column - width + 1, cursor_column);
+  }
+  scroll.y = std::clamp(scroll.y, 0, int(state.line_count()) - 1);
+  scroll.x = std::max(scroll.x, 0);
+
+  if (buffer.empty()) {
+    auto const [text, visible_width, offset] = text_columns(xxx::to_unicode(placeholder), 0, width);
+    auto const placeholder_style =
+        get_style(active ? im_style_id::input_active_placeholder : im_style_id::input_inactive_placeholder);
+    g_ctx->renderer.cmd_draw_text_at(widget_rect.min, text, visible_width, placeholder_style);
+  }
+
+  // decode and draw only visible lines
+  auto const last_line = std::min<int>(scroll.y + height, state.line_count());
+  for (auto line = scroll.y; line < last_line; ++line) {
+    auto const begin = state.line_begin(line);
+    auto const end = state.line_end(buffer, line);
+    if (begin < end) {
+      auto const [text, visible_width, offset] =
+          text_columns(to_unicode(buffer, begin, end - begin), scroll.x, width);
+      g_ctx->renderer.cmd_draw_text_at(
+          widget_rect.min + im_vec2(offset, line - scroll.y), text, visible_width, style);
+    }
+  }
+
+  if (active) {
+    auto const cursor_ch = g_ctx->allocator.allocate<std::uint32_t>();
+    if (cursor_ch) [[likely]] {
+      auto const line_end = state.line_end(buffer, cursor_line);
+      *cursor_ch = state.cursor < line_end ? buffer[state.cursor] : std::uint32_t(' ');
+      g_ctx->renderer.cmd_draw_text_at(widget_rect.min + im_vec2(cursor_column - scroll.x, cursor_line - scroll.y),
+          std::span<std::uint32_t const>(cursor_ch, 1), style.with_reverse());
+    }
+  }
+}
+
+} // namespace internal
+
+auto text_editor(std::string_view name, im_text_buffer& buffer, int height) -> bool {
+  auto& widget = g_ctx->widget;
+
+  auto const widget_rect = g_ctx->layout.reserve_layout_lines(std::max(height, 1));
+  auto const [str, widget_key] = g_ctx->hash_id.split_str_key(name);
+  auto const widget_id = g_ctx->hash_id.make(widget_key);
+
+  internal::common_focusable_behaviour(widget_id);
+
+  auto& state = g_ctx->text_editor[widget_id];
+  state.sync(buffer);
+
+  auto text_changed = false;
+  if (widget.active) {
+    text_changed = internal::text_editor_edit(state, buffer);
+  }
+
+  if (g_ctx->renderer.is_visible(widget_rect)) {
+    internal::text_editor_draw(widget_rect, str, state, buffer, widget.active);
+  }
+
+  return text_changed;
 }
 
 namespace {
@@ -997,8 +2032,8 @@ constexpr auto progress_glyph = std::to_array<std::uint32_t>({L'⣿', L'⡇'});
 void spinner(std::string_view text, float& step) {
   static constexpr int spinner_min_width = 10;
 
-  auto const unicode_text = to_unicode(text);
-  auto const spinner_width = std::max<int>(spinner_min_width, unicode_text.size() + 2);
+  auto const metrics = to_text_metrics(text);
+  auto const spinner_width = std::max<int>(spinner_min_width, metrics.width + 2);
   auto const widget_rect = g_ctx->layout.add_widget_item(im_vec2(spinner_width, 1));
 
   // update step
@@ -1010,10 +2045,10 @@ void spinner(std::string_view text, float& step) {
 
   auto const index = std::size_t(std::round(step / spinner_update_interval)) % spinner_glyphs.size();
 
-  auto const style = g_ctx->theme.get_style(im_color_id::text, im_color_id::background);
+  auto const style = g_ctx->theme.get_style(im_style_id::text);
   g_ctx->renderer.cmd_fill_rect(widget_rect, ' ', style);
   g_ctx->renderer.cmd_draw_text_at(widget_rect.min, std::span<std::uint32_t const>(&spinner_glyphs[index], 1), style);
-  g_ctx->renderer.cmd_draw_text_at(widget_rect.min + im_vec2(1, 0), unicode_text, style);
+  g_ctx->renderer.cmd_draw_text_at(widget_rect.min + im_vec2(1, 0), metrics.text, metrics.width, style);
 }
 
 void progress(float const& value) {
@@ -1035,7 +2070,7 @@ void progress(float const& value) {
   auto const text = std::span<std::uint32_t>(buffer, static_cast<std::size_t>(progress_total_length));
   std::fill(std::fill_n(text.begin(), progress_length, progress_glyph[0]), text.end(), L' ');
 
-  auto const style = g_ctx->theme.get_style(im_color_id::text, im_color_id::background);
+  auto const style = g_ctx->theme.get_style(im_style_id::text);
   g_ctx->renderer.cmd_draw_text_at(widget_rect.min, text, style);
 }
 
@@ -1072,7 +2107,7 @@ auto canvas_begin(im_vec2 p_size) -> bool {
   g_ctx->renderer.push_clip_rect(canvas.rect);
 
   if (!canvas.data.empty()) {
-    auto const style = g_ctx->theme.get_style(im_color_id::text, im_color_id::background);
+    auto const style = g_ctx->theme.get_style(im_style_id::text);
     std::fill(canvas.data.begin(), canvas.data.end(), im_cell{.ch = braille_offset, .style = style});
     g_ctx->renderer.cmd_fill_rect(canvas.rect, ' ', style);
   }
@@ -3,11 +3,18 @@
 
 #pragma once
 
+#include <cstddef>
+#include <format>
+#include <initializer_list>
+#include <limits>
 #include <source_location>
+#include <span>
 #include <string_view>
+#include <utility>
 
 #include "im_color.h"
 #include "im_rect.h"
+#include "im_text_buffer.h"
 #include "im_vec2.h"
 
 namespace xxx {
@@ -19,6 +26,12 @@ template <typename T, typename Tag = void>
   return value;
 }
 
+// free space of frame arena for formatted text
+[[nodiscard]] auto format_buffer() noexcept -> std::span<char>;
+
+// take formatted text from front of format_buffer() and draw label
+void labelf(std::size_t size);
+
 } // namespace detail
 
 /// Keyboard key ids
@@ -61,6 +74,34 @@ enum class im_key_id {
   ctrl_x,
   ctrl_y,
   ctrl_z,
+  insert,
+  pgup,
+  pgdn,
+  back_tab, // shift-tab
+  f1,
+  f2,
+  f3,
+  f4,
+  f5,
+  f6,
+  f7,
+  f8,
+  f9,
+  f10,
+  f11,
+  f12,
+  shift_arrow_up,
+  shift_arrow_down,
+  shift_arrow_left,
+  shift_arrow_right,
+  alt_arrow_up,
+  alt_arrow_down,
+  alt_arrow_left,
+  alt_arrow_right,
+  ctrl_arrow_up,
+  ctrl_arrow_down,
+  ctrl_arrow_left,
+  ctrl_arrow_right,
   last
 };
 
@@ -93,8 +134,13 @@ enum class im_color_id {
   last
 };
 
+constexpr auto im_init_flag_input_thread = int(1 << 0);
+
 /// Init library
-void init();
+/// flags:
+///   im_init_flag_input_thread - read and decode terminal input on a dedicated thread,
+///                               process_input_events() drains already decoded events
+void init(int flags = 0);
 
 /// Shutdown library
 void shutdown();
@@ -108,6 +154,31 @@ void new_frame();
 /// Render frame
 void render();
 
+/// Frame statistics
+struct im_frame_stats {
+  /// bytes written to terminal
+  std::size_t output_bytes = 0;
+  /// cells written to terminal
+  std::size_t output_cells = 0;
+  /// rows compared cell by cell (hash differs from previous frame)
+  std::size_t changed_rows = 0;
+  /// rows skipped as equal to previous frame by hash
+  std::size_t skipped_rows = 0;
+  /// texts found in metrics cache
+  std::size_t text_cache_hits = 0;
+  /// texts decoded and measured
+  std::size_t text_cache_misses = 0;
+  /// stacks (layout, clip rect, id, color) grown past inline capacity
+  std::size_t stack_grows = 0;
+  /// frame containers allocations not fitted into frame arena (served by heap)
+  std::size_t arena_overflows = 0;
+  /// input events processed during frame
+  std::size_t input_events = 0;
+};
+
+/// Get statistics of last rendered frame
+[[nodiscard]] auto get_frame_stats() -> im_frame_stats const&;
+
 // XXX: remove
 void debug();
 
@@ -117,6 +188,25 @@ void debug();
 /// Check key pressed
 [[nodiscard]] auto is_key_pressed(im_key_id id) -> bool;
 
+/// Check last focusable widget is under mouse cursor
+[[nodiscard]] auto is_item_hovered() -> bool;
+
+/// Check last focusable widget clicked by left mouse button
+[[nodiscard]] auto is_item_clicked() -> bool;
+
+/// Check left mouse button pressed on last focusable widget and still held
+[[nodiscard]] auto is_item_dragged() -> bool;
+
+/// Get mouse offset since left mouse button pressed on widget
+[[nodiscard]] auto get_mouse_drag_delta() -> im_vec2;
+
+/// Load default colors from theme file
+/// @param path is theme file path, file contains line per color (# starts comment):
+///   <color id name> = 0xRRGGBB | default
+/// @param watch is reload file on change (applied on next new_frame())
+/// @return false on file read or parse error
+auto load_theme(std::string_view path, bool watch = true) -> bool;
+
 /// Set default color
 void set_default_color(im_color_id id, im_color color);
 
@@ -134,32 +224,120 @@ void layout_row_begin(std::size_t columns);
 /// @param ratio_or_width is ratio of parent layout width (in case of value < 1.0) or width in chars
 void layout_row_push(float ratio_or_width);
 
+/// Column constraints of flex row layout
+struct im_flex {
+  /// preferred width in chars
+  int basis = 0;
+  /// min width in chars
+  int min = 0;
+  /// max width in chars
+  int max = std::numeric_limits<int>::max();
+  /// share of row space left after preferred widths (0 - column doesn't grow)
+  float grow = 0.0f;
+};
+
+/// Fixed width column
+[[nodiscard]] constexpr auto im_flex_fixed(int width) noexcept -> im_flex {
+  return im_flex{.basis = width, .min = width, .max = width, .grow = 0.0f};
+}
+
+/// Column takes share of free row space
+[[nodiscard]] constexpr auto im_flex_grow(
+    float grow, int min = 0, int max = std::numeric_limits<int>::max()) noexcept -> im_flex {
+  return im_flex{.basis = 0, .min = min, .max = max, .grow = grow};
+}
+
+/// Begin flex row layout
+/// Columns get preferred widths, space left is shared by grow weights, missed space is taken from columns
+/// in proportion to their width above min. Solution is cached while row width and constraints are unchanged.
+/// @param columns is columns constraints (column switched by layout_row_push())
+void layout_row_begin(std::span<im_flex const> columns);
+
+/// Begin flex row layout
+/// @overload
+inline void layout_row_begin(std::initializer_list<im_flex> columns) {
+  layout_row_begin(std::span(columns.begin(), columns.size()));
+}
+
+/// Push next column of flex row layout
+void layout_row_push();
+
 /// End row layout
 void layout_row_end();
 
+/// Begin grid layout
+/// Columns widths are solved as flex row (see layout_row_begin(...)), cells are placed by index.
+/// Rows are expected to be visited in order, row starts below tallest cell of previous row.
+/// Cells of a row share its height (tallest cell of previous frame for dynamic rows), cell background
+/// is filled over whole cell.
+/// @param columns is columns constraints
+/// @param rows is number of rows
+/// @param row_height is fixed row height in lines (0 - row fits tallest cell)
+void grid_begin(std::span<im_flex const> columns, int rows, int row_height = 0);
+
+/// Begin grid layout
+/// @overload
+inline void grid_begin(std::initializer_list<im_flex> columns, int rows, int row_height = 0) {
+  grid_begin(std::span(columns.begin(), columns.size()), rows, row_height);
+}
+
+/// Place next widgets into grid cell
+/// @param column is cell column index
+/// @param row is cell row index (not less than row of previous cell)
+void grid_cell(int column, int row);
+
+/// End grid layout
+void grid_end();
+
 /// Place next widget at the same line
 void same_line();
 
+// -----------------------------------------
+// Key bindings
+// -----------------------------------------
+
+/// Bind key sequence to action
+/// @param keys is space separated sequence, element is key label or single character (i.e. "c-x c-s", "g g")
+/// @param action is action name for is_action_triggered(...)
+/// @param view is view name for binding active only inside that view (empty for global binding)
+/// @return false on invalid key sequence (or sequence longer than 8 keys)
+///
+/// Sequence which is a prefix of longer one fires on timeout or on next non-matching key.
+/// Keys matched by bindings are consumed and not seen by widgets (i.e. focused text_input),
+/// prefer view bindings for sequences of plain characters.
+auto bind_keys(std::string_view keys, std::string_view action, std::string_view view = {}) -> bool;
+
+/// Check action triggered by key bindings during current frame
+[[nodiscard]] auto is_action_triggered(std::string_view action) -> bool;
+
 // -----------------------------------------
 // View
 // -----------------------------------------
 
 constexpr auto im_view_flag_border = int(1 << 0);
 constexpr auto im_view_flag_title = int(1 << 1);
+constexpr auto im_view_flag_scroll = int(1 << 2);
+constexpr auto im_view_flag_collapsible = int(1 << 3);
 
 /// Begin view
+/// @param height is content height in lines for im_view_flag_scroll (0 - up to the bottom of screen)
 /// flags:
 ///   im_view_flag_border - draw border around view
 ///   im_view_flag_title - show view name with shortcut (if set)
+///   im_view_flag_scroll - fixed height view, content scrolled by mouse wheel or arrow keys
+///   im_view_flag_collapsible - view collapsed to title line by mouse click on it (shortcut expands view)
+/// @return true on view content visible, false if view collapsed or out of screen
+///         (content must be skipped, view_end() call is optional then)
 /// theme:
 ///   view_border - border color when im_view_flag_border is set
 ///   view_active_border - border color when im_view_flag_border is set and view is active
 ///   view_title - title color when im_view_flag_title is set
 ///   view_active_title - title color when im_view_flag_title is set and view is active
-void view_begin(std::string_view name, int flags, im_key_id shortcut = im_key_id());
+[[nodiscard]] auto view_begin(
+    std::string_view name, int flags, im_key_id shortcut = im_key_id(), int height = 0) -> bool;
 
 /// @overload
-inline void view_begin(std::string_view name, im_key_id shortcut = im_key_id()) {
+[[nodiscard]] inline auto view_begin(std::string_view name, im_key_id shortcut = im_key_id()) -> bool {
   return view_begin(name, im_view_flag_border | im_view_flag_title, shortcut);
 }
 
@@ -176,12 +354,30 @@ void panel_begin();
 /// End panel
 void panel_end();
 
+constexpr auto im_label_flag_wrap = int(1 << 0);
+constexpr auto im_label_flag_ellipsis = int(1 << 1);
+
 /// Widget: label
 /// @param text is label text
+/// flags:
+///   im_label_flag_wrap - break text into lines at spaces to fit available width
+///   im_label_flag_ellipsis - truncate text to available width, cut tail is replaced with "…"
 ///
 /// theme:
 ///   text - label color
-void label(std::string_view text);
+void label(std::string_view text, int flags = 0);
+
+/// Widget: label with formatted text (see std::format)
+/// Text is formatted directly into frame arena (no std::string), cut if arena is exhausted.
+///
+/// theme:
+///   text - label color
+template <typename... Ts>
+void labelf(std::format_string<Ts...> fmt, Ts&&... args) {
+  auto const buffer = detail::format_buffer();
+  auto const result = std::format_to_n(buffer.data(), std::ptrdiff_t(buffer.size()), fmt, std::forward<Ts>(args)...);
+  detail::labelf(std::size_t(result.size));
+}
 
 /// Widget: button
 /// @param label is widget label
@@ -201,6 +397,10 @@ auto button(std::string_view label) -> bool;
 /// @param input is reference to string storagage for input
 /// @return true on "enter" pressed
 ///
+/// Active widget edits its own buffer and re-encodes whole input once per changed frame, use
+/// im_text_buffer overload for large texts. Changes of input made outside of active widget are
+/// detected by size and storage address only, so same size in-place edits are not seen.
+///
 /// theme:
 ///   input_inactive_background
 ///   input_inactive_text
@@ -211,6 +411,24 @@ auto button(std::string_view label) -> bool;
 ///   input_placeholder
 auto text_input(std::string_view placeholder, std::string& input, int flags = 0) -> bool;
 
+/// @overload
+/// @param buffer is text storage, edited in-place (utf8 value is available through im_text_buffer::str())
+auto text_input(std::string_view placeholder, im_text_buffer& buffer, int flags = 0) -> bool;
+
+/// Widget: multi-line text editor
+/// @param name is editor name (shown as placeholder when text is empty)
+/// @param buffer is text storage, edited in-place
+/// @param height is editor height in lines
+/// @return true on text changed
+///
+/// theme:
+///   input_inactive_background
+///   input_inactive_text
+///   input_active_background
+///   input_active_text
+///   input_placeholder
+auto text_editor(std::string_view name, im_text_buffer& buffer, int height) -> bool;
+
 /// Widget: spinner
 /// @param text is optional spinner text
 /// @param step is storage for step counter